@@ -2,38 +2,353 @@
 # define COMPRESSED_SUFFIX_TREE_HPP_
 
 # include <unordered_map>
+# include <vector>
+# include <algorithm>
 # include <string>
 # include <string_view>
 # include <memory>
 # include <utility>
+# include <optional>
+# include <functional>
+# include <type_traits>
+# include <istream>
+# include <ostream>
+# include <cstdint>
+# include <cstddef>
+# include <iterator>
 # include <cassert>
 
+# include "Instrumentation.hpp"
+# include "Normalization.hpp"
+# include "Pattern.hpp"
+# include "QueryScheduler.hpp"
+
 # define assertm(EXPR, MSG) assert((void(MSG), EXPR))
 
 namespace container
 {
-    template <template <typename...> typename Alloc = std::allocator>
-    class CompressedSuffixTree
+    namespace detail
+    {
+        // value attached to a stored word, empty when the tree is used as a set
+        template <typename Value>
+        struct PayloadStorage
+        {
+            Value value{};
+        };
+
+        template <>
+        struct PayloadStorage<void>
+        { };
+
+        /* spellings of a stored word differing from its normalized form, and
+           whether the normalized form itself was inserted (verbatim) */
+        template <typename Originals, bool Enabled>
+        struct OriginalStorage
+        {
+            OriginalStorage() = default;
+
+            template <typename Allocator>
+            explicit OriginalStorage(const Allocator& allocator) :
+                originals(allocator)
+            { }
+
+            bool verbatim = false;
+            Originals originals;
+        };
+
+        template <typename Originals>
+        struct OriginalStorage<Originals, false>
+        {
+            OriginalStorage() = default;
+
+            template <typename Allocator>
+            explicit OriginalStorage(const Allocator&) noexcept
+            { }
+        };
+
+        struct TreeAccess;
+    }
+
+    /* Instrumentation is a policy of Instrumentation.hpp receiving the work
+       done by each operation, nothing is measured with the default one.
+
+       Normalizer is a policy of Normalization.hpp : words are stored in their
+       normalized form, queries are normalized while descending the tree, and
+       iterators give normalized words.
+
+       Alloc may be stateful, e.g. std::pmr::polymorphic_allocator : the
+       allocator given at construction serves the nodes, their strings and
+       their child maps. As for the standard containers, a copy gets the
+       allocator of select_on_container_copy_construction and nodes are only
+       moved between trees whose allocators are equal */
+    template <template <typename...> typename Alloc = std::allocator,
+              typename Value = void,
+              typename Instrumentation = instrumentation::None,
+              typename Normalizer = normalization::Identity>
+    class CompressedSuffixTree : private Instrumentation
     {
         struct Node;
 
+        // parameter type of "insert" for values, never used when Value is void
+        using Value_t = std::conditional_t<
+            std::is_void_v<Value>, std::nullptr_t, Value>;
+
+        using AllocatorTraits_t = std::allocator_traits<Alloc<char>>;
+
     public :
+        using mapped_type = Value;
+        using allocator_type = Alloc<char>;
+
+        /* visits in lexicographic order either the stored words or the strings
+           for which "endsWith" is true. The current string is kept in a single
+           buffer and is only valid until the iterator is incremented, any
+           modification of the tree invalidates the iterator */
+        class const_iterator
+        {
+        public :
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = std::string;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const std::string*;
+            using reference = const std::string&;
+
+            const_iterator() = default;
+
+            [[nodiscard]]
+            inline reference operator*() const noexcept { return _path; }
+
+            [[nodiscard]]
+            inline pointer operator->() const noexcept { return &_path; }
+
+            const_iterator& operator++()
+            {
+                next();
+
+                return *this;
+            }
+
+            const_iterator operator++(int)
+            {
+                auto it = *this;
+
+                next();
+
+                return it;
+            }
+
+            [[nodiscard]]
+            friend inline bool operator==(
+                const const_iterator& lhs, const const_iterator& rhs) noexcept
+            {
+                return lhs.node() == rhs.node();
+            }
+
+            [[nodiscard]]
+            friend inline bool operator!=(
+                const const_iterator& lhs, const const_iterator& rhs) noexcept
+            {
+                return !(lhs == rhs);
+            }
+
+            [[nodiscard]]
+            inline size_t frequency() const noexcept { return node()->frequency; }
+
+            template <typename V = Value,
+                      std::enable_if_t<!std::is_void_v<V>, int> = 0>
+            [[nodiscard]]
+            inline const V& value() const noexcept { return node()->value; }
+
+        private :
+            friend class CompressedSuffixTree;
+
+            struct Frame
+            {
+                const Node* node = nullptr;
+                int lastChar = -1; // first character of the last visited child
+            };
+
+            std::vector<Frame> _stack;
+            std::string _path;
+            bool _suffixes = false;
+
+            static constexpr int noMoreChild = 256;
+
+            // a null root gives the end iterator
+            const_iterator(const Node* root, bool suffixes) :
+                _suffixes(suffixes)
+            {
+                if (root)
+                {
+                    _stack.push_back({root, -1});
+                }
+            }
+
+            [[nodiscard]]
+            inline const Node* node() const noexcept
+            {
+                return _stack.empty() ? nullptr : _stack.back().node;
+            }
+
+            [[nodiscard]]
+            bool accepts(const Node* node) const noexcept
+            {
+                return _suffixes ?
+                    (node->terminalCount > (node->terminalWord ? 1 : 0)) :
+                    node->terminalWord;
+            }
+
+            [[nodiscard]]
+            static const Node* nextChild(const Node* node, int lastChar) noexcept
+            {
+                const Node* res = nullptr;
+                int resChar = noMoreChild;
+
+                for (const auto& [sv, childNode] : node->childNodes)
+                {
+                    int c = static_cast<unsigned char>(sv[0]);
+
+                    if (c > lastChar && c < resChar)
+                    {
+                        res = childNode.get();
+                        resChar = c;
+                    }
+                }
+
+                return res;
+            }
+
+            void push(const Node* node)
+            {
+                _stack.back().lastChar = static_cast<unsigned char>(node->s[0]);
+                _stack.push_back({node, -1});
+                _path.append(node->s);
+            }
+
+            // pre-order traversal until the next accepted node
+            void next()
+            {
+                while (!_stack.empty())
+                {
+                    if (auto childNode = nextChild(_stack.back().node,
+                                                   _stack.back().lastChar))
+                    {
+                        push(childNode);
+
+                        if (accepts(childNode))
+                        {
+                            return;
+                        }
+                    }
+                    else
+                    {
+                        _path.resize(_path.size() - _stack.back().node->s.size());
+                        _stack.pop_back();
+                    }
+                }
+            }
+
+            // moves on the first accepted string not less than key
+            void seek(std::string_view key)
+            {
+                if (_stack.empty())
+                {
+                    return;
+                }
+
+                for (size_t depth = 0; depth < key.size();)
+                {
+                    auto node = _stack.back().node;
+                    auto [it, endPos] = node->findByDeterminingPrefix(
+                        key.substr(depth));
+
+                    if (it == node->childNodes.cend())
+                    {
+                        // continues with the children greater than key[depth]
+                        _stack.back().lastChar = static_cast<unsigned char>(
+                            key[depth]);
+                        next();
+
+                        return;
+                    }
+
+                    push(it->second.get());
+
+                    if (endPos == it->first.size())
+                    {
+                        depth += endPos;
+
+                        continue;
+                    }
+
+                    if (depth + endPos < key.size()
+                        && static_cast<unsigned char>(it->first[endPos])
+                           < static_cast<unsigned char>(key[depth + endPos]))
+                    {
+                        // the whole subtree is less than key
+                        _stack.back().lastChar = noMoreChild;
+                        next();
+
+                        return;
+                    }
+
+                    break;
+                }
+
+                // the current node and its subtree are not less than key
+                if (!accepts(_stack.back().node))
+                {
+                    next();
+                }
+            }
+        };
+
+        using iterator = const_iterator;
+
+        template <typename Iterator>
+        struct Range
+        {
+            Iterator first;
+            Iterator last;
+
+            [[nodiscard]]
+            inline Iterator begin() const { return first; }
+
+            [[nodiscard]]
+            inline Iterator end() const { return last; }
+        };
+
         CompressedSuffixTree() = default;
 
+        explicit CompressedSuffixTree(const allocator_type& allocator) noexcept :
+            _allocator(allocator)
+        { }
+
         CompressedSuffixTree(const CompressedSuffixTree& other) :
+            CompressedSuffixTree(
+                other,
+                AllocatorTraits_t::select_on_container_copy_construction(other._allocator))
+        { }
+
+        CompressedSuffixTree(const CompressedSuffixTree& other, const allocator_type& allocator) :
+            _allocator(allocator),
             _size(other._size),
             _wordCount(other._wordCount),
-            _root(Node::deepCopy(other._root))
+            _root(Node::deepCopy(other._root, _allocator))
         { }
 
-        CompressedSuffixTree(CompressedSuffixTree&& other) :
+        // the other tree is left empty, without root
+        CompressedSuffixTree(CompressedSuffixTree&& other) noexcept :
+            _allocator(std::move(other._allocator)),
             _size(std::exchange(other._size, 0)),
             _wordCount(std::exchange(other._wordCount, 0)),
-            _root(std::exchange(
-                other._root, std::allocate_shared<Node>(Alloc<Node>{})))
-        { }
+            _root(std::move(other._root))
+        {
+            ++other._generation;
+        }
 
-        CompressedSuffixTree(std::initializer_list<std::string_view> initList)
+        CompressedSuffixTree(std::initializer_list<std::string_view> initList,
+                             const allocator_type& allocator = allocator_type()) :
+            _allocator(allocator)
         {
             for (auto sv : initList)
             {
@@ -42,7 +357,9 @@ namespace container
         }
 
         template <typename InputIterator>
-        CompressedSuffixTree(InputIterator begin, InputIterator end)
+        CompressedSuffixTree(InputIterator begin, InputIterator end,
+                             const allocator_type& allocator = allocator_type()) :
+            _allocator(allocator)
         {
             for (; begin != end; ++begin)
             {
@@ -54,34 +371,63 @@ namespace container
         {
             if (this != &other)
             {
+                if constexpr (AllocatorTraits_t::propagate_on_container_copy_assignment::value)
+                {
+                    _allocator = other._allocator;
+                }
+
                 _size = other._size;
                 _wordCount = other._wordCount;
-                _root = Node::deepCopy(other._root);
+                _root = Node::deepCopy(other._root, _allocator);
+                ++_generation;
             }
 
             return *this;
         }
 
-        CompressedSuffixTree& operator=(CompressedSuffixTree&& other)
+        // nodes are copied when the allocators differ and aren't propagated
+        CompressedSuffixTree& operator=(CompressedSuffixTree&& other) noexcept(
+            AllocatorTraits_t::propagate_on_container_move_assignment::value
+            || AllocatorTraits_t::is_always_equal::value)
         {
             if (this != &other)
             {
+                if constexpr (AllocatorTraits_t::propagate_on_container_move_assignment::value)
+                {
+                    _allocator = std::move(other._allocator);
+                }
+                else if (_allocator != other._allocator)
+                {
+                    *this = static_cast<const CompressedSuffixTree&>(other);
+                    other.clear();
+
+                    return *this;
+                }
+
                 _size = std::exchange(other._size, 0);
                 _wordCount = std::exchange(other._wordCount, 0);
-                _root = std::exchange(
-                    other._root, std::allocate_shared<Node>(Alloc<Node>{}));
+                _root = std::move(other._root);
+                ++_generation;
+                ++other._generation;
             }
 
             return *this;
         }
 
+        [[nodiscard]]
+        inline allocator_type get_allocator() const noexcept { return _allocator; }
+
         [[nodiscard]]
         friend inline bool operator==(
             const CompressedSuffixTree& lhs, const CompressedSuffixTree& rhs) noexcept
         {
+            // an empty tree may or may not have a root
             return lhs._size == rhs._size
                 && lhs._wordCount == rhs._wordCount
-                && Node::deepEqual(lhs._root, rhs._root);
+                && lhs.fingerprint() == rhs.fingerprint()
+                && (lhs.empty() ?
+                    rhs.empty() :
+                    !rhs.empty() && Node::deepEqual(lhs._root, rhs._root));
         }
 
         [[nodiscard]]
@@ -92,7 +438,10 @@ namespace container
         }
 
         [[nodiscard]]
-        inline bool empty() const noexcept { return _root->childNodes.empty(); }
+        inline bool empty() const noexcept
+        {
+            return !_root || _root->childNodes.empty();
+        }
 
         [[nodiscard]]
         inline size_t size() const noexcept { return _size; }
@@ -100,6 +449,92 @@ namespace container
         [[nodiscard]]
         inline size_t wordCount() const noexcept { return _wordCount; }
 
+        /* changed by every modification of the words of the tree (not of
+           their values), so that results computed at the same generation
+           are still valid */
+        [[nodiscard]]
+        inline std::uint64_t generation() const noexcept { return _generation; }
+
+        [[nodiscard]]
+        inline const Instrumentation& instrumentation() const noexcept { return *this; }
+
+        [[nodiscard]]
+        inline Instrumentation& instrumentation() noexcept { return *this; }
+
+        // stored words in lexicographic order
+        [[nodiscard]]
+        const_iterator begin() const
+        {
+            const_iterator it(_root.get(), false);
+
+            it.next();
+
+            return it;
+        }
+
+        [[nodiscard]]
+        inline const_iterator end() const noexcept { return {}; }
+
+        [[nodiscard]]
+        inline const_iterator cbegin() const { return begin(); }
+
+        [[nodiscard]]
+        inline const_iterator cend() const noexcept { return end(); }
+
+        // strings for which "endsWith" is true, in lexicographic order
+        [[nodiscard]]
+        Range<const_iterator> suffixes() const
+        {
+            const_iterator it(_root.get(), true);
+
+            it.next();
+
+            return {std::move(it), {}};
+        }
+
+        // first stored word not less than key
+        [[nodiscard]]
+        const_iterator lower_bound(std::string_view key) const
+        {
+            Scope_t scope(*this, instrumentation::Operation::Seek);
+            std::string buffer;
+            const_iterator it(_root.get(), false);
+
+            it.seek(normalizedKey(key, buffer));
+
+            return it;
+        }
+
+        // first stored word greater than key
+        [[nodiscard]]
+        const_iterator upper_bound(std::string_view key) const
+        {
+            std::string buffer;
+            auto it = lower_bound(key);
+
+            if (it != end() && *it == normalizedKey(key, buffer))
+            {
+                ++it;
+            }
+
+            return it;
+        }
+
+        // stored words within [lo, hi)
+        [[nodiscard]]
+        Range<const_iterator> range(std::string_view lo, std::string_view hi) const
+        {
+            std::string buffer;
+            std::string buffer2;
+
+            if (!(normalizedKey(lo, buffer) < normalizedKey(hi, buffer2)))
+            {
+                return {};
+            }
+
+            return {lower_bound(lo), lower_bound(hi)};
+        }
+
 #ifdef SUFFIXTREE_TEST
         [[nodiscard]]
         inline std::weak_ptr<const Node> root() const noexcept
@@ -111,191 +546,1534 @@ namespace container
         [[nodiscard]]
          inline bool search(std::string_view word) const
         {
-            return search(_root, word);
+            Scope_t scope(*this, instrumentation::Operation::Search);
+
+            if constexpr (Normalizer::identity)
+            {
+                return _root && search(_root, word);
+            }
+            else
+            {
+                auto node = locate(word);
+
+                return node && node->terminalWord;
+            }
         }
 
         [[nodiscard]]
         inline bool endsWith(std::string_view suffix) const
         {
-            return endsWith(_root, suffix);
+            Scope_t scope(*this, instrumentation::Operation::EndsWith);
+
+            if constexpr (Normalizer::identity)
+            {
+                return _root && endsWith(_root, suffix);
+            }
+            else
+            {
+                auto node = locate(suffix);
+
+                return node && node->terminalCount > (node->terminalWord ? 1 : 0);
+            }
         }
 
-        bool insert(std::string_view word)
+        /* stored words matched as a whole by the pattern, in lexicographic
+           order. Patterns are matched against the normalized words, subtrees
+           are left as soon as no state of the pattern is active */
+        [[nodiscard]]
+        std::vector<std::string> searchPattern(const Pattern& pattern) const
+        {
+            return matchPattern(pattern, false);
+        }
+
+        // distinct non-empty substrings of the stored words matched by the pattern
+        [[nodiscard]]
+        std::vector<std::string> substringsMatching(const Pattern& pattern) const
+        {
+            return matchPattern(pattern, true);
+        }
+
+#ifdef __cpp_impl_coroutine
+        /* same as search and endsWith, but suspending after having prefetched
+           each dependent load of the descent, to be interleaved with other
+           lookups by a QueryScheduler. The query must outlive the task, the tree must not
+           be modified before the task is done. Not instrumented */
+        [[nodiscard]]
+        inline Task<bool> co_search(std::string_view word) const
+        {
+            return coLookup(word, false);
+        }
+
+        [[nodiscard]]
+        inline Task<bool> co_endsWith(std::string_view suffix) const
+        {
+            return coLookup(suffix, true);
+        }
+#endif
+
+        /* k most frequent substrings of at least minLength characters, each
+           one is the longest substring sharing its occurrences, sorted by
+           decreasing number of occurrences among the stored words */
+        [[nodiscard]]
+        std::vector<std::pair<std::string, size_t>> frequentSubstrings(
+            size_t k, size_t minLength = 1) const
         {
-            if (word.empty() || !insert(_root, word, true))
+            std::vector<std::pair<std::string, size_t>> heap;
+            std::string path;
+
+            if (k > 0 && _root)
             {
-                return false;
+                heap.reserve(k);
+                frequentSubstrings(_root, k, minLength, path, heap);
+                std::sort_heap(heap.begin(), heap.end(), moreFrequent);
             }
 
-            for (size_t n = 1; n < word.size(); ++n)
+            return heap;
+        }
+
+        /* substrings of at least minLength characters occurring at least twice
+           and whose occurrences can't all be extended by a same character
+           on the left or on the right (an end of word is a distinct context),
+           sorted by lexicographic order with their number of occurrences */
+        [[nodiscard]]
+        std::vector<std::pair<std::string, size_t>> maximalRepeats(
+            size_t minLength = 1) const
+        {
+            std::vector<std::pair<std::string, size_t>> res;
+            std::vector<Locus> left;
+            std::string path;
+
+            if (!_root)
             {
-                bool res = insert(_root, word.substr(n), false);
+                return res;
+            }
 
-                assertm(res, "res cannot be false");
+            // the empty string is preceded by every first character
+            for (const auto& [_, childNode] : _root->childNodes)
+            {
+                left.push_back({childNode.get(), 1});
             }
 
-            return true;
+            maximalRepeats(*_root, left, minLength, path, res);
+            std::sort(res.begin(), res.end());
+
+            return res;
         }
 
-        bool erase(std::string_view word)
+        /* structural hash of the tree (stored words and suffix counts, values
+           and frequencies excluded), identical for equal trees whatever the
+           process or the machine, kept up to date by every modification */
+        [[nodiscard]]
+        inline std::uint64_t fingerprint() const noexcept
+        {
+            return _root ? _root->hash : emptyFingerprint();
+        }
+
+        /* hash of the part of the tree below prefix, 0 if no stored string
+           starts with prefix */
+        [[nodiscard]]
+        std::uint64_t fingerprint(std::string_view prefix) const
         {
-            if (word.empty() || !erase(_root, word, true))
+            std::string buffer;
+
+            prefix = normalizedKey(prefix, buffer);
+
+            if (prefix.empty())
             {
-                return false;
+                return fingerprint();
+            }
+
+            const Node* node = _root.get();
+
+            while (node && !prefix.empty())
+            {
+                auto [it, endPos] = node->findByDeterminingPrefix(prefix);
+
+                if (it == node->childNodes.cend()
+                    || (endPos < it->first.size() && endPos < prefix.size()))
+                {
+                    return 0;
+                }
+
+                node = it->second.get();
+                prefix.remove_prefix(std::min(endPos, prefix.size()));
             }
 
-            for (size_t n = 1; n < word.size(); ++n)
+            return node ? node->hash : 0;
+        }
+
+        /* shortest path from the root to a part of the trees which differs,
+           found by descending into subtrees with different hashes */
+        [[nodiscard]]
+        std::optional<std::string> firstDifference(
+            const CompressedSuffixTree& other) const
+        {
+            if (fingerprint() == other.fingerprint())
+            {
+                return std::nullopt;
+            }
+
+            if (!_root || !other._root)
+            {
+                return std::string();
+            }
+
+            std::string path;
+
+            firstDifference(*_root, *other._root, path);
+
+            return path;
+        }
+
+        // spellings with which a word was inserted, empty if it isn't stored
+        template <typename N = Normalizer,
+                  std::enable_if_t<!N::identity, int> = 0>
+        [[nodiscard]]
+        std::vector<std::string> originals(std::string_view word) const
+        {
+            std::vector<std::string> res;
+
+            if (auto node = lookupWord(word))
+            {
+                if (node->verbatim)
+                {
+                    res.push_back(normalization::normalize<Normalizer>(word));
+                }
+
+                res.insert(res.end(), node->originals.cbegin(), node->originals.cend());
+            }
+
+            return res;
+        }
+
+        [[nodiscard]]
+        inline size_t frequency(std::string_view word) const
+        {
+            Scope_t scope(*this, instrumentation::Operation::Find);
+            auto node = lookupWord(word);
+
+            return node ? node->frequency : 0;
+        }
+
+        template <typename V = Value,
+                  std::enable_if_t<!std::is_void_v<V>, int> = 0>
+        [[nodiscard]]
+        std::optional<std::reference_wrapper<V>> find(std::string_view word)
+        {
+            Scope_t scope(*this, instrumentation::Operation::Find);
+            auto node = lookupWord(word);
+
+            if (!node)
+            {
+                return std::nullopt;
+            }
+
+            return std::ref(node->value);
+        }
+
+        template <typename V = Value,
+                  std::enable_if_t<!std::is_void_v<V>, int> = 0>
+        [[nodiscard]]
+        std::optional<std::reference_wrapper<const V>> find(
+            std::string_view word) const
+        {
+            Scope_t scope(*this, instrumentation::Operation::Find);
+            auto node = lookupWord(word);
+
+            if (!node)
+            {
+                return std::nullopt;
+            }
+
+            return std::cref(node->value);
+        }
+
+        /* returns false if the word is empty or already stored, in the last
+           case only its frequency is incremented */
+        bool insert(std::string_view word)
+        {
+            return insertWord(word) != nullptr;
+        }
+
+        // the value is left untouched if the word is already stored
+        template <typename V = Value,
+                  std::enable_if_t<!std::is_void_v<V>, int> = 0>
+        bool insert(std::string_view word, Value_t value)
+        {
+            auto node = insertWord(word);
+
+            if (!node)
+            {
+                return false;
+            }
+
+            node->value = std::move(value);
+
+            return true;
+        }
+
+        bool erase(std::string_view word)
+        {
+            Scope_t scope(*this, instrumentation::Operation::Erase);
+            std::string buffer;
+
+            word = normalizedKey(word, buffer);
+
+            if (word.empty() || !_root || !erase(_root, word, true))
+            {
+                return false;
+            }
+
+            ++_generation;
+
+            for (size_t n = 1; n < word.size(); ++n)
+            {
+                bool res = erase(_root, word.substr(n), false);
+
+                assertm(res, "res cannot false");
+            }
+
+            return true;
+        }
+
+        /* stores the words of the other tree, subtrees which only exist in
+           one tree are reused as is if the allocators are equal, the other
+           tree is left empty */
+        void merge(CompressedSuffixTree&& other)
+        {
+            if (this != &other)
+            {
+                merge(other, _allocator == other._allocator);
+                other.clear();
+            }
+        }
+
+        // stores the words of the other tree, only unshared subtrees are copied
+        void merge(const CompressedSuffixTree& other)
+        {
+            if (this != &other)
+            {
+                merge(other, false);
+            }
+        }
+
+        // releases all nodes, the root included
+        void clear() noexcept
+        {
+            _size = 0;
+            _wordCount = 0;
+            _root.reset();
+            ++_generation;
+        }
+
+        /* writes the nodes in pre-order, so that loading doesn't have to
+           insert suffixes again. Values must be trivially copyable */
+        void save(std::ostream& os) const
+        {
+            static_assert(std::is_void_v<Value> || std::is_trivially_copyable_v<Value>,
+                          "values must be trivially copyable to be saved");
+
+            os.write(snapshotMagic, sizeof(snapshotMagic));
+            writeRaw(os, static_cast<std::uint64_t>(_size));
+            writeRaw(os, static_cast<std::uint64_t>(_wordCount));
+            // a tree without root is saved as having an empty one
+            if (_root)
+            {
+                save(os, *_root);
+            }
+            else
+            {
+                save(os, Node(_allocator));
+            }
+        }
+
+        // returns false and leaves the tree empty if the stream is invalid
+        bool load(std::istream& is)
+        {
+            static_assert(std::is_void_v<Value> || std::is_trivially_copyable_v<Value>,
+                          "values must be trivially copyable to be loaded");
+
+            Scope_t scope(*this, instrumentation::Operation::Load);
+            char magic[sizeof(snapshotMagic)] = {};
+            std::uint64_t size = 0;
+            std::uint64_t wordCount = 0;
+            auto root = makeNode();
+
+            clear();
+
+            if (!is.read(magic, sizeof(magic))
+                || !std::equal(std::cbegin(magic), std::cend(magic),
+                               std::cbegin(snapshotMagic))
+                || !readRaw(is, size)
+                || !readRaw(is, wordCount)
+                || !load(is, root))
+            {
+                return false;
+            }
+
+            _size = size;
+            _wordCount = wordCount;
+            _root = std::move(root);
+
+            return true;
+        }
+
+    private :
+        friend struct detail::TreeAccess;
+
+        using Scope_t = instrumentation::Scope<Instrumentation>;
+
+        static constexpr char snapshotMagic[4] = {'C', 'S', 'T', '1'};
+
+        // adds n to a counter of the current operation, compiled out when disabled
+        static void record(size_t instrumentation::OperationStats::* counter,
+                           size_t n = 1) noexcept
+        {
+            if constexpr (Instrumentation::enabled)
+            {
+                instrumentation::currentStats().*counter += n;
+            }
+        }
+
+        template <typename T>
+        static void writeRaw(std::ostream& os, const T& value)
+        {
+            os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        template <typename T>
+        [[nodiscard]]
+        static bool readRaw(std::istream& is, T& value)
+        {
+            return static_cast<bool>(
+                is.read(reinterpret_cast<char*>(&value), sizeof(value)));
+        }
+
+        void save(std::ostream& os, const Node& node) const
+        {
+            writeRaw(os, static_cast<std::uint32_t>(node.s.size()));
+            os.write(node.s.data(), node.s.size());
+            writeRaw(os, static_cast<std::uint8_t>(node.terminalWord));
+            writeRaw(os, static_cast<std::int32_t>(node.terminalCount));
+            writeRaw(os, static_cast<std::uint32_t>(node.frequency));
+
+            if constexpr (!std::is_void_v<Value>)
+            {
+                writeRaw(os, node.value);
+            }
+
+            if constexpr (!Normalizer::identity)
+            {
+                writeRaw(os, static_cast<std::uint8_t>(node.verbatim));
+                writeRaw(os, static_cast<std::uint32_t>(node.originals.size()));
+
+                for (const auto& original : node.originals)
+                {
+                    writeRaw(os, static_cast<std::uint32_t>(original.size()));
+                    os.write(original.data(), original.size());
+                }
+            }
+
+            writeRaw(os, static_cast<std::uint32_t>(node.childNodes.size()));
+
+            for (const auto& [_, childNode] : node.childNodes)
+            {
+                save(os, *childNode);
+            }
+        }
+
+        [[nodiscard]]
+        bool load(std::istream& is, const std::shared_ptr<Node>& node)
+        {
+            std::uint32_t length = 0;
+            std::uint8_t terminalWord = 0;
+            std::int32_t terminalCount = 0;
+            std::uint32_t frequency = 0;
+            std::uint32_t childCount = 0;
+
+            if (!readRaw(is, length))
+            {
+                return false;
+            }
+
+            node->s.resize(length);
+
+            if (!is.read(node->s.data(), length)
+                || !readRaw(is, terminalWord)
+                || !readRaw(is, terminalCount)
+                || !readRaw(is, frequency))
+            {
+                return false;
+            }
+
+            node->terminalWord = terminalWord;
+            node->terminalCount = terminalCount;
+            node->frequency = frequency;
+
+            if constexpr (!std::is_void_v<Value>)
+            {
+                if (!readRaw(is, node->value))
+                {
+                    return false;
+                }
+            }
+
+            if constexpr (!Normalizer::identity)
+            {
+                std::uint8_t verbatim = 0;
+                std::uint32_t originalCount = 0;
+
+                if (!readRaw(is, verbatim) || !readRaw(is, originalCount))
+                {
+                    return false;
+                }
+
+                node->verbatim = verbatim;
+
+                for (std::uint32_t n = 0; n < originalCount; ++n)
+                {
+                    std::uint32_t originalLength = 0;
+
+                    if (!readRaw(is, originalLength))
+                    {
+                        return false;
+                    }
+
+                    auto& original = node->originals.emplace_back(originalLength, '\0');
+
+                    if (!is.read(original.data(), originalLength))
+                    {
+                        return false;
+                    }
+                }
+            }
+
+            if (!readRaw(is, childCount))
+            {
+                return false;
+            }
+
+            for (std::uint32_t n = 0; n < childCount; ++n)
+            {
+                auto childNode = makeNode();
+
+                if (!load(is, childNode) || childNode->s.empty())
+                {
+                    return false;
+                }
+
+                node->childNodes.emplace(childNode->s, childNode);
+                node->updateChild(0, childNode->hash);
+            }
+
+            node->rehash();
+
+            return true;
+        }
+
+        void merge(const CompressedSuffixTree& other, bool steal)
+        {
+            Scope_t scope(*this, instrumentation::Operation::Merge);
+            std::string path;
+            std::vector<std::string> duplicates;
+
+            if (!other._root)
+            {
+                return;
+            }
+
+            ++_generation;
+
+            if (!_root)
+            {
+                _root = makeNode();
+            }
+
+            _size += other._size;
+            _wordCount += other._wordCount;
+            merge(_root, other._root, steal, path, duplicates);
+
+            /* suffixes of a word stored in both trees have been counted twice,
+               their nodes can't be removed since counts stay positive */
+            for (std::string_view word : duplicates)
+            {
+                --_wordCount;
+
+                for (size_t n = 0; n < word.size(); ++n)
+                {
+                    bool res = erase(_root, word.substr(n), false);
+
+                    assertm(res, "res cannot be false");
+                }
+            }
+        }
+
+        using CustomString_t = std::basic_string<
+            char, std::char_traits<char>, Alloc<char>>;
+
+        template <typename Key, typename T>
+        using CustomHashMap_t = std::unordered_map<
+            Key,
+            T,
+            std::hash<Key>,
+            std::equal_to<Key>,
+            Alloc<std::pair<const Key, T>>>;
+
+        using ChildMap_t = CustomHashMap_t<
+            std::string_view, std::shared_ptr<Node>>;
+
+        /* children of a node, with the interface of the hash map used by the
+           nodes. The map is only allocated with the first child : most nodes
+           are leaves, which then cost a null pointer instead of an empty map */
+        class ChildTable
+        {
+        public :
+            using key_type = typename ChildMap_t::key_type;
+            using mapped_type = typename ChildMap_t::mapped_type;
+            using value_type = typename ChildMap_t::value_type;
+            using iterator = typename ChildMap_t::iterator;
+            using const_iterator = typename ChildMap_t::const_iterator;
+            using node_type = typename ChildMap_t::node_type;
+            using insert_return_type = typename ChildMap_t::insert_return_type;
+
+            ChildTable() = default;
+
+            explicit ChildTable(const allocator_type& allocator) noexcept :
+                _map(nullptr, MapDeleter(allocator))
+            { }
+
+            ChildTable(ChildTable&&) noexcept = default;
+
+            // allocators may not be assignable, those of the nodes of a tree are equal
+            ChildTable& operator=(ChildTable&& other) noexcept
+            {
+                assertm(static_cast<const Alloc<ChildMap_t>&>(_map.get_deleter())
+                        == static_cast<const Alloc<ChildMap_t>&>(other._map.get_deleter()),
+                        "children must be moved between equal allocators");
+                _map.reset(other._map.release());
+
+                return *this;
+            }
+
+            [[nodiscard]]
+            inline bool empty() const noexcept { return !_map; }
+
+            [[nodiscard]]
+            inline size_t size() const noexcept { return _map ? _map->size() : 0; }
+
+            // address of the map to be prefetched, nullptr for a leaf
+            [[nodiscard]]
+            inline const void* storage() const noexcept { return _map.get(); }
+
+            [[nodiscard]]
+            inline iterator begin() noexcept { return map().begin(); }
+
+            [[nodiscard]]
+            inline iterator end() noexcept { return map().end(); }
+
+            [[nodiscard]]
+            inline const_iterator begin() const noexcept { return map().cbegin(); }
+
+            [[nodiscard]]
+            inline const_iterator end() const noexcept { return map().cend(); }
+
+            [[nodiscard]]
+            inline const_iterator cbegin() const noexcept { return map().cbegin(); }
+
+            [[nodiscard]]
+            inline const_iterator cend() const noexcept { return map().cend(); }
+
+            [[nodiscard]]
+            inline iterator find(key_type key) { return map().find(key); }
+
+            [[nodiscard]]
+            inline const_iterator find(key_type key) const { return map().find(key); }
+
+            template <typename... Args>
+            std::pair<iterator, bool> emplace(Args&&... args)
+            {
+                return allocated().emplace(std::forward<Args>(args)...);
+            }
+
+            insert_return_type insert(node_type&& nh)
+            {
+                return allocated().insert(std::move(nh));
+            }
+
+            // the map is kept, the child is usually inserted again
+            [[nodiscard]]
+            inline node_type extract(const_iterator it) { return _map->extract(it); }
+
+            // the map is released with the last child
+            iterator erase(const_iterator it)
+            {
+                auto res = _map->erase(it);
+
+                if (_map->empty())
+                {
+                    _map.reset();
+
+                    return end();
+                }
+
+                return res;
+            }
+
+        private :
+            // holds the allocator of the map, which takes no room when stateless
+            struct MapDeleter : Alloc<ChildMap_t>
+            {
+                MapDeleter() = default;
+
+                explicit MapDeleter(const allocator_type& allocator) noexcept :
+                    Alloc<ChildMap_t>(allocator)
+                { }
+
+                void operator()(ChildMap_t* map)
+                {
+                    std::allocator_traits<Alloc<ChildMap_t>>::destroy(*this, map);
+                    std::allocator_traits<Alloc<ChildMap_t>>::deallocate(*this, map, 1);
+                }
+            };
+
+            std::unique_ptr<ChildMap_t, MapDeleter> _map;
+
+            // shared by all the leaves to give them valid empty ranges
+            [[nodiscard]]
+            static ChildMap_t& emptyMap() noexcept
+            {
+                static ChildMap_t map;
+
+                return map;
+            }
+
+            [[nodiscard]]
+            inline ChildMap_t& map() const noexcept
+            {
+                return _map ? *_map : emptyMap();
+            }
+
+            ChildMap_t& allocated()
+            {
+                if (!_map)
+                {
+                    Alloc<ChildMap_t>& alloc = _map.get_deleter();
+                    auto map = std::allocator_traits<Alloc<ChildMap_t>>::allocate(alloc, 1);
+
+                    // the map gets the allocator itself, even without uses-allocator construction
+                    try
+                    {
+                        ::new (static_cast<void*>(map)) ChildMap_t(
+                            typename ChildMap_t::allocator_type(alloc));
+                    }
+                    catch (...)
+                    {
+                        std::allocator_traits<Alloc<ChildMap_t>>::deallocate(alloc, map, 1);
+
+                        throw;
+                    }
+
+                    _map.reset(map);
+                }
+
+                return *_map;
+            }
+        };
+
+        using ChildNodes_t = ChildTable;
+
+        using Originals_t = std::vector<CustomString_t, Alloc<CustomString_t>>;
+
+        struct Node : detail::PayloadStorage<Value>,
+                      detail::OriginalStorage<Originals_t, !Normalizer::identity>
+        {
+            Node() = default;
+
+            explicit Node(const allocator_type& allocator) :
+                detail::OriginalStorage<Originals_t, !Normalizer::identity>(allocator),
+                s(allocator),
+                childNodes(allocator)
+            { }
+
+            CustomString_t s = "";
+            bool terminalWord = false; // true means that's node represents end of word
+            int terminalCount = 0; /* could represent end of word as well as end of
+                                      suffixes from others words */
+            unsigned int frequency = 0; // number of insertions of the word ending here
+            std::uint64_t hash = 0; // structural hash of the subtree
+            std::uint64_t childSum = 0; // sum of the hashes of the children
+
+            // must be called after any change of the node or of childSum
+            void rehash() noexcept
+            {
+                hash = combine(ownHash(s, terminalWord, terminalCount), childSum);
+            }
+
+            /* the hash of a child went from oldHash to newHash, 0 standing for
+               a child attached or detached */
+            inline void updateChild(std::uint64_t oldHash, std::uint64_t newHash) noexcept
+            {
+                childSum += newHash - oldHash;
+            }
+
+            // takes the children of another node with their sum
+            void takeChildren(Node& other) noexcept
+            {
+                childNodes = std::move(other.childNodes);
+                childSum = std::exchange(other.childSum, 0);
+            }
+
+            /* to optimize the search, we should use a Compressed Trie / Prefix Tree
+               rather than a hash map */
+            ChildNodes_t childNodes;
+
+            // moves the end of word / suffixes information of another node
+            void takeTerminal(Node& other)
+            {
+                terminalWord = std::exchange(other.terminalWord, false);
+                terminalCount = std::exchange(other.terminalCount, 0);
+                frequency = std::exchange(other.frequency, 0);
+
+                if constexpr (!std::is_void_v<Value>)
+                {
+                    this->value = std::exchange(other.value, Value{});
+                }
+
+                if constexpr (!Normalizer::identity)
+                {
+                    this->verbatim = std::exchange(other.verbatim, false);
+                    // both vectors keep the allocator of the tree
+                    this->originals = std::move(other.originals);
+                    other.originals.clear();
+                }
+            }
+
+            // copies everything but the children
+            void copyFields(const Node& other)
+            {
+                s = other.s;
+                terminalWord = other.terminalWord;
+                terminalCount = other.terminalCount;
+                frequency = other.frequency;
+                hash = other.hash;
+                childSum = other.childSum;
+
+                if constexpr (!std::is_void_v<Value>)
+                {
+                    this->value = other.value;
+                }
+
+                if constexpr (!Normalizer::identity)
+                {
+                    this->verbatim = other.verbatim;
+                    this->originals = other.originals;
+                }
+            }
+
+            // compares everything but the children, except their number
+            [[nodiscard]]
+            bool sameFields(const Node& other) const noexcept
+            {
+                if (hash != other.hash
+                    || s != other.s
+                    || terminalWord != other.terminalWord
+                    || terminalCount != other.terminalCount
+                    || childNodes.size() != other.childNodes.size())
+                {
+                    return false;
+                }
+
+                if constexpr (!std::is_void_v<Value>)
+                {
+                    if (terminalWord && !(this->value == other.value))
+                    {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            [[nodiscard]]
+            static std::shared_ptr<Node> deepCopy(const std::shared_ptr<Node> nodeOther,
+                                                  const allocator_type& allocator)
+            {
+                if (!nodeOther)
+                {
+                    return nullptr;
+                }
+
+                auto node = makeNode(allocator);
+
+                node->copyFields(*nodeOther);
+
+                for (const auto& [_, childNodeOther] : nodeOther->childNodes)
+                {
+                    auto childNode = deepCopy(childNodeOther, allocator);
+
+                    node->childNodes.emplace(childNode->s, childNode);
+                }
+
+                return node;
+            }
+
+            [[nodiscard]]
+            static bool deepEqual(const std::shared_ptr<Node> node,
+                                  const std::shared_ptr<Node> nodeOther)
+            {
+                if (!node && !nodeOther)
+                {
+                    return true;
+                }
+                else if (!node || !nodeOther || !node->sameFields(*nodeOther))
+                {
+                    return false;
+                }
+
+                for (const auto& [sv, childNode] : node->childNodes)
+                {
+                    auto it = nodeOther->childNodes.find(sv);
+
+                    if (it == nodeOther->childNodes.cend()
+                        || !deepEqual(childNode, it->second))
+                    {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            [[nodiscard]]
+            auto findByFirstChar(char c) const
+            {
+                auto begin = childNodes.cbegin();
+                auto end = childNodes.cend();
+
+                size_t scanned = 1;
+
+                while (begin != end && begin->first[0] != c)
+                {
+                    ++begin;
+                    ++scanned;
+                }
+
+                record(&instrumentation::OperationStats::childEntriesScanned,
+                       std::min(scanned, childNodes.size()));
+
+                return begin;
+            }
+
+            [[nodiscard]]
+            auto findByDeterminingPrefix(std::string_view sv) const
+                -> std::pair<
+                    typename std::decay_t<decltype(childNodes)>::const_iterator,
+                    size_t>
+            {
+                if (sv.empty())
+                {
+                    return {{}, 0};
+                }
+
+                record(&instrumentation::OperationStats::nodesVisited);
+
+                auto it = findByFirstChar(sv[0]);
+
+                if (it == childNodes.cend())
+                {
+                    return {{}, 0};
+                }
+
+                size_t endPos = 1;
+
+                while (endPos < it->first.size()
+                       && endPos < sv.size()
+                       && it->first[endPos] == sv[endPos])
+                {
+                    ++endPos;
+                }
+
+                record(&instrumentation::OperationStats::labelBytesCompared, endPos);
+
+                return {it, endPos};
+            }
+        };
+
+        allocator_type _allocator; // of all the nodes
+        size_t _size = 0;
+        size_t _wordCount = 0;
+        std::uint64_t _generation = 0;
+        std::shared_ptr<Node> _root; // allocated by the first insertion
+
+        [[nodiscard]]
+        static std::shared_ptr<Node> makeNode(const allocator_type& allocator)
+        {
+            record(&instrumentation::OperationStats::allocations);
+
+            return std::allocate_shared<Node>(Alloc<Node>(allocator), allocator);
+        }
+
+        [[nodiscard]]
+        inline std::shared_ptr<Node> makeNode() const { return makeNode(_allocator); }
+
+        [[nodiscard]]
+        bool search(const std::shared_ptr<Node> node, std::string_view word) const
+        {
+            if (word.empty())
+            {
+                return node->terminalWord;
+            }
+
+            auto [it, endPos] = node->findByDeterminingPrefix(word);
+
+            return (it != node->childNodes.cend() && endPos >= it->first.size()) ?
+                search(it->second, word.substr(endPos)) : false;
+        }
+
+        [[nodiscard]]
+        static std::uint64_t mix(std::uint64_t x) noexcept
+        {
+            // splitmix64 finalizer
+            x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+            x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+
+            return x ^ (x >> 31);
+        }
+
+        [[nodiscard]]
+        static std::uint64_t ownHash(std::string_view s,
+                                     bool terminalWord,
+                                     int terminalCount) noexcept
+        {
+            // FNV-1a, byte by byte so that it doesn't depend on endianness
+            std::uint64_t hash = 14695981039346656037ull;
+
+            for (unsigned char c : s)
+            {
+                hash = (hash ^ c) * 1099511628211ull;
+            }
+
+            return mix(hash
+                       + ((static_cast<std::uint64_t>(terminalCount) << 1)
+                          | terminalWord));
+        }
+
+        // children hashes are summed so that their order doesn't matter
+        [[nodiscard]]
+        static std::uint64_t combine(std::uint64_t own,
+                                     std::uint64_t childSum) noexcept
+        {
+            return mix(own + childSum);
+        }
+
+        [[nodiscard]]
+        static std::uint64_t emptyFingerprint() noexcept
+        {
+            return combine(ownHash({}, false, 0), 0);
+        }
+
+        // appends to path the part of the trees which differs from node
+        void firstDifference(const Node& node,
+                             const Node& nodeOther,
+                             std::string& path) const
+        {
+            if (node.terminalWord != nodeOther.terminalWord
+                || node.terminalCount != nodeOther.terminalCount)
+            {
+                return;
+            }
+
+            // the least differing child to be deterministic
+            const Node* res = nullptr;
+            const Node* resOther = nullptr;
+
+            auto check = [&](const Node* childNode, const Node* childNodeOther)
+            {
+                auto& first = childNode ? childNode->s : childNodeOther->s;
+
+                if ((!childNode || !childNodeOther
+                     || childNode->hash != childNodeOther->hash)
+                    && ((!res && !resOther)
+                        || static_cast<unsigned char>(first[0])
+                           < static_cast<unsigned char>(
+                               (res ? res : resOther)->s[0])))
+                {
+                    res = childNode;
+                    resOther = childNodeOther;
+                }
+            };
+
+            for (const auto& [sv, childNode] : node.childNodes)
+            {
+                auto it = nodeOther.findByFirstChar(sv[0]);
+
+                check(childNode.get(),
+                      it != nodeOther.childNodes.cend() ? it->second.get() : nullptr);
+            }
+
+            for (const auto& [sv, childNodeOther] : nodeOther.childNodes)
+            {
+                if (node.findByFirstChar(sv[0]) == node.childNodes.cend())
+                {
+                    check(nullptr, childNodeOther.get());
+                }
+            }
+
+            if (!res || !resOther)
+            {
+                // only one tree has strings going on with this character
+                if (res || resOther)
+                {
+                    path.push_back((res ? res : resOther)->s[0]);
+                }
+
+                return;
+            }
+
+            if (res->s != resOther->s)
+            {
+                auto endPos = std::mismatch(res->s.cbegin(), res->s.cend(),
+                                            resOther->s.cbegin(), resOther->s.cend());
+
+                path.append(res->s.cbegin(), endPos.first);
+
+                return;
+            }
+
+            path.append(res->s);
+            firstDifference(*res, *resOther, path);
+        }
+
+        [[nodiscard]]
+        static bool moreFrequent(const std::pair<std::string, size_t>& lhs,
+                                 const std::pair<std::string, size_t>& rhs) noexcept
+        {
+            return lhs.second > rhs.second
+                || (lhs.second == rhs.second && lhs.first < rhs.first);
+        }
+
+        /* returns the number of suffixes ending in the subtree of node, heap
+           keeps the least frequent substring found so far on its top */
+        size_t frequentSubstrings(
+            const std::shared_ptr<Node>& node,
+            size_t k,
+            size_t minLength,
+            std::string& path,
+            std::vector<std::pair<std::string, size_t>>& heap) const
+        {
+            size_t count = node->terminalCount;
+
+            for (const auto& [sv, childNode] : node->childNodes)
+            {
+                path.append(sv);
+                count += frequentSubstrings(childNode, k, minLength, path, heap);
+                path.resize(path.size() - sv.size());
+            }
+
+            if (node == _root || path.size() < minLength)
+            {
+                return count;
+            }
+
+            if (heap.size() < k)
+            {
+                heap.emplace_back(path, count);
+                std::push_heap(heap.begin(), heap.end(), moreFrequent);
+            }
+            else if (count > heap.front().second
+                     || (count == heap.front().second && path < heap.front().first))
+            {
+                std::pop_heap(heap.begin(), heap.end(), moreFrequent);
+                heap.back().first.assign(path);
+                heap.back().second = count;
+                std::push_heap(heap.begin(), heap.end(), moreFrequent);
+            }
+
+            return count;
+        }
+
+        // on the edge leading to node, after its first offset characters
+        struct Locus
+        {
+            const Node* node;
+            size_t offset;
+        };
+
+        // moves locus along sv, false if the substring can't be extended by sv
+        [[nodiscard]]
+        static bool extend(Locus& locus, std::string_view sv)
+        {
+            while (!sv.empty())
+            {
+                if (locus.offset == locus.node->s.size())
+                {
+                    auto it = locus.node->findByFirstChar(sv[0]);
+
+                    if (it == locus.node->childNodes.cend())
+                    {
+                        return false;
+                    }
+
+                    locus = {it->second.get(), 0};
+                }
+
+                auto label = std::string_view(locus.node->s).substr(locus.offset);
+                auto n = std::min(label.size(), sv.size());
+
+                if (label.substr(0, n) != sv.substr(0, n))
+                {
+                    return false;
+                }
+
+                locus.offset += n;
+                sv.remove_prefix(n);
+            }
+
+            return true;
+        }
+
+        /* "left" holds the loci of cy for each character c preceding the path
+           y of node somewhere. y is left-diverse when it is preceded by two
+           characters, or starts a word. Returns the number of suffixes ending
+           in the subtree and whether it holds the end of a word */
+        std::pair<size_t, bool> maximalRepeats(
+            const Node& node,
+            const std::vector<Locus>& left,
+            size_t minLength,
+            std::string& path,
+            std::vector<std::pair<std::string, size_t>>& res) const
+        {
+            size_t count = node.terminalCount;
+            bool startsWord = node.terminalWord;
+            std::vector<Locus> childLeft;
+
+            for (const auto& [sv, childNode] : node.childNodes)
+            {
+                childLeft.clear();
+
+                for (auto locus : left)
+                {
+                    if (extend(locus, sv))
+                    {
+                        childLeft.push_back(locus);
+                    }
+                }
+
+                path.append(sv);
+
+                auto [childCount, childStartsWord] =
+                    maximalRepeats(*childNode, childLeft, minLength, path, res);
+
+                path.resize(path.size() - sv.size());
+                count += childCount;
+                startsWord = startsWord || childStartsWord;
+            }
+
+            if (&node != _root.get()
+                && path.size() >= minLength
+                && count > 1
+                && node.childNodes.size()
+                   + static_cast<size_t>(node.terminalCount) > 1
+                && (left.size() != 1 || startsWord))
+            {
+                res.emplace_back(path, count);
+            }
+
+            return {count, startsWord};
+        }
+
+        [[nodiscard]]
+        Node* findWord(const std::shared_ptr<Node>& node, std::string_view word) const
+        {
+            if (word.empty())
+            {
+                return node->terminalWord ? node.get() : nullptr;
+            }
+
+            auto [it, endPos] = node->findByDeterminingPrefix(word);
+
+            return (it != node->childNodes.cend() && endPos >= it->first.size()) ?
+                findWord(it->second, word.substr(endPos)) : nullptr;
+        }
+
+        // key itself, or its normalized form written in buffer
+        [[nodiscard]]
+        static std::string_view normalizedKey(std::string_view key, std::string& buffer)
+        {
+            if constexpr (Normalizer::identity)
+            {
+                return key;
+            }
+            else
+            {
+                buffer = normalization::normalize<Normalizer>(key);
+
+                return buffer;
+            }
+        }
+
+        /* node whose path is the normalized query, which is normalized while
+           descending so that no string is allocated */
+        [[nodiscard]]
+        Node* locate(std::string_view query) const
+        {
+            typename Normalizer::Reader reader(query);
+            Node* node = _root.get();
+
+            if (!node || reader.empty())
+            {
+                return nullptr;
+            }
+
+            while (!reader.empty())
+            {
+                auto it = node->findByFirstChar(reader.get());
+
+                if (it == node->childNodes.cend())
+                {
+                    return nullptr;
+                }
+
+                record(&instrumentation::OperationStats::nodesVisited);
+
+                const auto& label = it->first;
+
+                for (size_t n = 1; n < label.size(); ++n)
+                {
+                    if (reader.empty() || reader.get() != label[n])
+                    {
+                        return nullptr;
+                    }
+                }
+
+                record(&instrumentation::OperationStats::labelBytesCompared,
+                       label.size());
+                node = it->second.get();
+            }
+
+            return node;
+        }
+
+        [[nodiscard]]
+        std::vector<std::string> matchPattern(const Pattern& pattern,
+                                              bool substrings) const
+        {
+            Scope_t scope(*this, instrumentation::Operation::Pattern);
+            std::vector<std::string> res;
+            std::vector<Pattern::StateSet> states = {pattern.start()};
+            std::string path;
+
+            if (_root)
             {
-                bool res = erase(_root, word.substr(n), false);
-
-                assertm(res, "res cannot false");
+                matchPattern(pattern, _root.get(), substrings, states, path, res);
             }
 
-            return true;
+            return res;
         }
 
-        void clear()
+        // states[n] are the active states after the n first characters of path
+        void matchPattern(const Pattern& pattern,
+                          const Node* node,
+                          bool substrings,
+                          std::vector<Pattern::StateSet>& states,
+                          std::string& path,
+                          std::vector<std::string>& res) const
         {
-            _size = 0;
-            _wordCount = 0;
-            _root = std::allocate_shared<Node>(Alloc<Node>{});
-        }
+            std::vector<const Node*> children;
 
-    private :
-        using CustomString_t = std::basic_string<
-            char, std::char_traits<char>, Alloc<char>>;
+            children.reserve(node->childNodes.size());
 
-        template <typename Key, typename T>
-        using CustomHashMap_t = std::unordered_map<
-            Key,
-            T,
-            std::hash<Key>,
-            std::equal_to<Key>,
-            Alloc<std::pair<const Key, T>>>;
+            for (const auto& [_, childNode] : node->childNodes)
+            {
+                children.push_back(childNode.get());
+            }
 
-        using ChildNodes_t = CustomHashMap_t<
-            std::string_view, std::shared_ptr<Node>>;
+            std::sort(children.begin(), children.end(),
+                      [](const Node* lhs, const Node* rhs)
+                      {
+                          return static_cast<unsigned char>(lhs->s[0])
+                              < static_cast<unsigned char>(rhs->s[0]);
+                      });
 
-        struct Node
-        {
-            CustomString_t s = "";
-            bool terminalWord = false; // true means that's node represents end of word
-            int terminalCount = 0; /* could represent end of word as well as end of
-                                      suffixes from others words */
+            for (auto childNode : children)
+            {
+                size_t depth = path.size();
+                bool alive = true;
 
-            /* to optimize the search, we should use a Compressed Trie / Prefix Tree
-               rather than a hash map */
-            ChildNodes_t childNodes;
+                record(&instrumentation::OperationStats::nodesVisited);
 
-            [[nodiscard]]
-            static std::shared_ptr<Node> deepCopy(const std::shared_ptr<Node> nodeOther)
-            {
-                if (!nodeOther)
+                for (char c : childNode->s)
                 {
-                    return nullptr;
-                }
+                    if (states.size() <= path.size() + 1)
+                    {
+                        states.resize(path.size() + 2);
+                    }
+
+                    record(&instrumentation::OperationStats::labelBytesCompared);
 
-                auto node = std::allocate_shared<Node>(Alloc<Node>{});
+                    if (!pattern.step(states[path.size()], c, states[path.size() + 1]))
+                    {
+                        alive = false;
+
+                        break;
+                    }
 
-                node->s = nodeOther->s;
-                node->terminalWord = nodeOther->terminalWord;
-                node->terminalCount = nodeOther->terminalCount;
+                    path.push_back(c);
 
-                for (const auto& [_, childNodeOther] : nodeOther->childNodes)
+                    if (substrings && pattern.accepts(states[path.size()]))
+                    {
+                        res.push_back(path);
+                    }
+                }
+
+                if (alive)
                 {
-                    auto childNode = deepCopy(childNodeOther);
+                    if (!substrings && childNode->terminalWord
+                        && pattern.accepts(states[path.size()]))
+                    {
+                        res.push_back(path);
+                    }
 
-                    node->childNodes.emplace(childNode->s, childNode);
+                    matchPattern(pattern, childNode, substrings, states, path, res);
                 }
 
-                return node;
+                path.resize(depth);
             }
+        }
 
-            [[nodiscard]]
-            static bool deepEqual(const std::shared_ptr<Node> node,
-                                  const std::shared_ptr<Node> nodeOther)
+#ifdef __cpp_impl_coroutine
+        /* locate, suspended before each load depending on the previous one :
+           the child node, then its label and its map, then the first entry
+           of the map where the next character is looked for */
+        Task<bool> coLookup(std::string_view query, bool suffix) const
+        {
+            typename Normalizer::Reader reader(query);
+            const Node* node = _root.get();
+
+            if (!node || reader.empty())
             {
-                if (!node && !nodeOther)
-                {
-                    return true;
-                }
-                else if (!node
-                         || !nodeOther
-                         || (node->s != nodeOther->s
-                             || node->terminalWord != nodeOther->terminalWord
-                             || node->terminalCount != nodeOther->terminalCount
-                             || node->childNodes.size() != nodeOther->childNodes.size()))
+                co_return false;
+            }
+
+            while (!reader.empty())
+            {
+                auto it = node->findByFirstChar(reader.get());
+
+                if (it == node->childNodes.cend())
                 {
-                    return false;
+                    co_return false;
                 }
 
-                for (const auto& [sv, childNode] : node->childNodes)
-                {
-                    auto it = nodeOther->childNodes.find(sv);
+                node = it->second.get();
 
-                    if (it == nodeOther->childNodes.cend()
-                        || !deepEqual(childNode, it->second))
+                co_await Prefetch{node};
+                co_await Prefetch{node->s.data(), node->childNodes.storage()};
+
+                const auto& label = node->s;
+
+                for (size_t n = 1; n < label.size(); ++n)
+                {
+                    if (reader.empty() || reader.get() != label[n])
                     {
-                        return false;
+                        co_return false;
                     }
                 }
 
-                return true;
+                if (!reader.empty() && !node->childNodes.empty())
+                {
+                    co_await Prefetch{std::addressof(*node->childNodes.cbegin())};
+                }
             }
 
-            [[nodiscard]]
-            auto findByDeterminingPrefix(std::string_view sv) const
-                -> std::pair<
-                    typename std::decay_t<decltype(childNodes)>::const_iterator,
-                    size_t>
+            co_return suffix ? node->terminalCount > (node->terminalWord ? 1 : 0)
+                             : node->terminalWord;
+        }
+#endif
+
+        [[nodiscard]]
+        Node* lookupWord(std::string_view word) const
+        {
+            if constexpr (Normalizer::identity)
             {
-                if (sv.empty())
+                return _root ? findWord(_root, word) : nullptr;
+            }
+            else
+            {
+                auto node = locate(word);
+
+                return (node && node->terminalWord) ? node : nullptr;
+            }
+        }
+
+        void addOriginal(Node& node, std::string_view word, std::string_view original)
+        {
+            if constexpr (!Normalizer::identity)
+            {
+                if (original == word)
                 {
-                    return {{}, 0};
+                    node.verbatim = true;
                 }
+                else if (std::find(node.originals.cbegin(), node.originals.cend(),
+                                   original) == node.originals.cend())
+                {
+                    node.originals.emplace_back(original);
+                }
+            }
+        }
 
-                auto begin = childNodes.cbegin();
-                auto end = childNodes.cend();
+        // returns the node of the newly stored word, nullptr otherwise
+        Node* insertWord(std::string_view word)
+        {
+            Scope_t scope(*this, instrumentation::Operation::Insert);
 
-                while (begin != end)
-                {
-                    if (begin->first[0] == sv[0])
-                    {
-                        size_t endPos = 1;
+            if constexpr (Normalizer::identity)
+            {
+                return insertWord(word, word);
+            }
+            else
+            {
+                return insertWord(normalization::normalize<Normalizer>(word), word);
+            }
+        }
 
-                        while (endPos < begin->first.size()
-                               && endPos < sv.size()
-                               && begin->first[endPos] == sv[endPos])
-                        {
-                            ++endPos;
-                        }
+        // word is the normalized form of original
+        Node* insertWord(std::string_view word, std::string_view original)
+        {
+            if (word.empty())
+            {
+                return nullptr;
+            }
 
-                        return {begin, endPos};
-                    }
+            ++_generation;
 
-                    ++begin;
-                }
+            if (!_root)
+            {
+                _root = makeNode();
+            }
+            else if (auto node = findWord(_root, word))
+            {
+                ++node->frequency;
+                addOriginal(*node, word, original);
 
-                return {{}, 0};
+                return nullptr;
             }
-        };
 
-        size_t _size = 0;
-        size_t _wordCount = 0;
-        std::shared_ptr<Node> _root = std::allocate_shared<Node>(Alloc<Node>{});
+            bool res = insert(_root, word, true);
 
-        [[nodiscard]]
-        bool search(const std::shared_ptr<Node> node, std::string_view word) const
-        {
-            if (word.empty())
+            assertm(res, "res cannot be false");
+
+            for (size_t n = 1; n < word.size(); ++n)
             {
-                return node->terminalWord;
+                res = insert(_root, word.substr(n), false);
+
+                assertm(res, "res cannot be false");
             }
 
-            auto [it, endPos] = node->findByDeterminingPrefix(word);
+            auto node = findWord(_root, word);
 
-            return (it != node->childNodes.cend() && endPos >= it->first.size()) ?
-                search(it->second, word.substr(endPos)) : false;
+            addOriginal(*node, word, original);
+
+            return node;
         }
 
         [[nodiscard]]
@@ -327,10 +2105,12 @@ namespace container
 
                     // node is considered as end of word now
                     node->terminalWord = true;
+                    node->frequency = 1;
                     ++_wordCount;
                 }
 
                 ++node->terminalCount;
+                node->rehash();
 
                 return true;
             }
@@ -341,7 +2121,7 @@ namespace container
 
             if (it == node->childNodes.cend())
             {
-                auto childNode = std::allocate_shared<Node>(Alloc<Node>{});
+                auto childNode = makeNode();
 
                 childNode->s.assign(sv.data(), sv.size());
                 it2 = node->childNodes.emplace(childNode->s, childNode).first;
@@ -352,59 +2132,185 @@ namespace container
             {
                 if (endPos < it->first.size())
                 {
-                    auto substr = std::string(
-                        it->first.data() + endPos,
-                        it->first.size() - endPos);
+                    it2 = split(node, it, endPos);
+                }
+                else
+                {
+                    auto sv2 = sv.substr(0, endPos);
 
-                    // iterator "it" will be invalid after this line
-                    auto containerNodeHandle = node->childNodes.extract(it);
+                    it2 = node->childNodes.find(sv2);
+                    assertm(it2 != node->childNodes.end(),
+                            "it2 cannot be null");
+                }
 
-                    auto childNode = containerNodeHandle.mapped();
+                endPos2 = endPos;
+            }
 
-                    // truncate string to keep prefix only
-                    childNode->s.resize(endPos);
+            // a new child has no hash yet
+            auto childNode = it2->second;
+            auto oldHash = childNode->hash;
+            bool res = insert(childNode, sv.substr(endPos2), isWord);
 
-                    bool terminalWord = std::exchange(
-                        childNode->terminalWord, false);
-                    int terminalCount = std::exchange(
-                        childNode->terminalCount, 0);
+            node->updateChild(oldHash, childNode->hash);
+            node->rehash();
 
-                    containerNodeHandle.key() = childNode->s;
+            return res;
+        }
 
-                    // reinsert the modified child node
-                    it2 = node->childNodes.insert(
-                        std::move(containerNodeHandle)).position;
+        /* cuts the edge of the child node pointed by "it" after endPos characters,
+           returns an iterator on the child node which keeps the prefix */
+        auto split(const std::shared_ptr<Node>& node,
+                   typename ChildNodes_t::const_iterator it,
+                   size_t endPos)
+        {
+            auto substr = std::string(
+                it->first.data() + endPos,
+                it->first.size() - endPos);
 
-                    assertm(it2 != node->childNodes.end(),
-                            "it2 cannot be null");
+            // iterator "it" will be invalid after this line
+            auto containerNodeHandle = node->childNodes.extract(it);
+
+            auto childNode = containerNodeHandle.mapped();
+            auto oldHash = childNode->hash;
+
+            // truncate string to keep prefix only
+            childNode->s.resize(endPos);
+
+            containerNodeHandle.key() = childNode->s;
+
+            // reinsert the modified child node
+            auto it2 = node->childNodes.insert(
+                std::move(containerNodeHandle)).position;
+
+            assertm(it2 != node->childNodes.end(),
+                    "it2 cannot be null");
+
+            auto childNode2 = makeNode();
+
+            childNode2->s = std::move(substr);
+            childNode2->takeTerminal(*childNode);
+            childNode2->takeChildren(*childNode);
 
-                    auto childNode2 = std::allocate_shared<Node>(Alloc<Node>{});
+            auto it3 = it2->second->childNodes.emplace(
+                childNode2->s, childNode2).first;
 
-                    childNode2->s = std::move(substr);
-                    childNode2->terminalWord = terminalWord;
-                    childNode2->terminalCount = terminalCount;
-                    childNode2->childNodes = std::move(it2->second->childNodes);
+            assertm(it3 != it2->second->childNodes.end(),
+                    "it3 cannot be null");
+            childNode2->rehash();
+            childNode->updateChild(0, childNode2->hash);
+            childNode->rehash();
+            node->updateChild(oldHash, childNode->hash);
+            ++_size;
+            record(&instrumentation::OperationStats::nodesSplit);
 
-                    auto it3 = it2->second->childNodes.emplace(
-                        childNode2->s, childNode2).first;
+            return it2;
+        }
+
+        /* node and nodeOther represent the same string (path), nodes of the
+           other tree are moved when "steal" is true, copied otherwise */
+        void merge(const std::shared_ptr<Node>& node,
+                   const std::shared_ptr<Node>& nodeOther,
+                   bool steal,
+                   std::string& path,
+                   std::vector<std::string>& duplicates)
+        {
+            node->terminalCount += nodeOther->terminalCount;
+
+            if (nodeOther->terminalWord)
+            {
+                if (node->terminalWord)
+                {
+                    node->frequency += nodeOther->frequency;
+                    duplicates.push_back(path);
+
+                    if constexpr (!Normalizer::identity)
+                    {
+                        node->verbatim = node->verbatim || nodeOther->verbatim;
 
-                    assertm(it3 != it2->second->childNodes.end(),
-                            "it3 cannot be null");
-                    ++_size;
+                        for (const auto& original : nodeOther->originals)
+                        {
+                            addOriginal(*node, {}, original);
+                        }
+                    }
                 }
                 else
                 {
-                    auto sv2 = sv.substr(0, endPos);
+                    node->terminalWord = true;
+                    node->frequency = nodeOther->frequency;
 
-                    it2 = node->childNodes.find(sv2);
-                    assertm(it2 != node->childNodes.end(),
-                            "it2 cannot be null");
+                    if constexpr (!std::is_void_v<Value>)
+                    {
+                        node->value = steal ?
+                            std::move(nodeOther->value) : nodeOther->value;
+                    }
+
+                    if constexpr (!Normalizer::identity)
+                    {
+                        node->verbatim = nodeOther->verbatim;
+                        node->originals = steal ?
+                            std::move(nodeOther->originals) : nodeOther->originals;
+                    }
                 }
+            }
 
-                endPos2 = endPos;
+            for (const auto& [_, childNodeOther] : nodeOther->childNodes)
+            {
+                mergeChild(node, childNodeOther, 0, steal, path, duplicates);
             }
 
-            return insert(it2->second, sv.substr(endPos2), isWord);
+            node->rehash();
+        }
+
+        /* merges childNodeOther, whose first "offset" characters of its string
+           are already part of the path, as a descendant of node */
+        void mergeChild(const std::shared_ptr<Node>& node,
+                        const std::shared_ptr<Node>& childNodeOther,
+                        size_t offset,
+                        bool steal,
+                        std::string& path,
+                        std::vector<std::string>& duplicates)
+        {
+            auto sv = std::string_view(childNodeOther->s).substr(offset);
+            auto [it, endPos] = node->findByDeterminingPrefix(sv);
+
+            if (it == node->childNodes.cend())
+            {
+                // whole subtree only exists in the other tree
+                auto childNode = steal ?
+                    childNodeOther : Node::deepCopy(childNodeOther, _allocator);
+
+                childNode->s.erase(0, offset);
+                childNode->rehash();
+                node->childNodes.emplace(childNode->s, childNode);
+                node->updateChild(0, childNode->hash);
+
+                return;
+            }
+
+            auto it2 = (endPos < it->first.size()) ?
+                split(node, it, endPos) :
+                node->childNodes.find(it->first);
+            auto childNode = it2->second;
+            auto oldHash = childNode->hash;
+
+            path.append(sv.substr(0, endPos));
+
+            if (endPos == sv.size())
+            {
+                // both nodes are merged into one
+                merge(childNode, childNodeOther, steal, path, duplicates);
+                --_size;
+                record(&instrumentation::OperationStats::nodesMerged);
+            }
+            else
+            {
+                mergeChild(childNode, childNodeOther,
+                           offset + endPos, steal, path, duplicates);
+                childNode->rehash();
+            }
+
+            node->updateChild(oldHash, childNode->hash);
+            path.resize(path.size() - endPos);
         }
 
         bool erase(std::shared_ptr<Node> node, std::string_view sv, bool isWord)
@@ -421,10 +2327,23 @@ namespace container
 
                     // node is no more considered as end of word
                     node->terminalWord = false;
+                    node->frequency = 0;
                     --_wordCount;
+
+                    if constexpr (!std::is_void_v<Value>)
+                    {
+                        node->value = Value{};
+                    }
+
+                    if constexpr (!Normalizer::identity)
+                    {
+                        node->verbatim = false;
+                        node->originals.clear();
+                    }
                 }
 
                 --node->terminalCount;
+                node->rehash();
 
                 return true;
             }
@@ -436,12 +2355,14 @@ namespace container
                 return false;
             }
 
+            auto oldHash = it->second->hash;
             bool res = erase(it->second, sv.substr(endPos), isWord);
 
             if (res && !it->second->terminalCount)
             {
                 if (it->second->childNodes.empty())
                 {
+                    node->updateChild(oldHash, 0);
                     node->childNodes.erase(it);
                     --_size;
                 }
@@ -474,19 +2395,101 @@ namespace container
                     // else
                     // {
 
-                    childNode->terminalWord = it2->second->terminalWord;
-                    childNode->terminalCount = it2->second->terminalCount;
+                    auto grandChildNode = it2->second;
+
+                    childNode->takeTerminal(*grandChildNode);
                     containerNodeHandle.key() = childNode->s;
                     node->childNodes.insert(std::move(containerNodeHandle));
 
-                    childNode->childNodes.erase(it2);
+                    // the merged node inherits the children of the removed one
+                    childNode->takeChildren(*grandChildNode);
+                    childNode->rehash();
+                    node->updateChild(oldHash, childNode->hash);
                     --_size;
+                    record(&instrumentation::OperationStats::nodesMerged);
+                }
+                else
+                {
+                    node->updateChild(oldHash, it->second->hash);
                 }
             }
+            else
+            {
+                node->updateChild(oldHash, it->second->hash);
+            }
+
+            node->rehash();
 
             return res;
         }
     };
+
+    namespace detail
+    {
+        // gives to the structures built from a tree a read access to its nodes
+        struct TreeAccess
+        {
+            // nullptr for a tree without root
+            template <typename Tree>
+            [[nodiscard]]
+            static auto root(const Tree& tree) noexcept
+            {
+                return static_cast<const typename Tree::Node*>(tree._root.get());
+            }
+
+            template <typename Tree>
+            [[nodiscard]]
+            static auto& rootPointer(Tree& tree) noexcept { return tree._root; }
+
+            // key itself, or its normalized form written in buffer
+            template <typename Tree>
+            [[nodiscard]]
+            static std::string_view normalizedKey(std::string_view key, std::string& buffer)
+            {
+                return Tree::normalizedKey(key, buffer);
+            }
+
+            template <typename Tree>
+            [[nodiscard]]
+            static auto makeNode(const Tree& tree) { return tree.makeNode(); }
+
+            // gives to tree the nodes of a copy of other built outside of it
+            template <typename Tree, typename NodePtr>
+            static void adopt(Tree& tree, const Tree& other, NodePtr root)
+            {
+                tree._size = other._size;
+                tree._wordCount = other._wordCount;
+                tree._root = std::move(root);
+                ++tree._generation;
+            }
+
+            /* inserts the path of a single suffix, ending a word if isWord,
+               without its own suffixes. The suffix is normalized as the words
+               of the tree, its original spelling isn't kept. Returns false for
+               a word already there */
+            template <typename Tree>
+            static bool insertSuffix(Tree& tree, std::string_view suffix, bool isWord)
+            {
+                std::string buffer;
+
+                suffix = Tree::normalizedKey(suffix, buffer);
+
+                if (suffix.empty())
+                {
+                    return false;
+                }
+
+                if (!tree._root)
+                {
+                    tree._root = tree.makeNode();
+                }
+
+                ++tree._generation;
+
+                return tree.insert(tree._root, suffix, isWord);
+            }
+        };
+    }
 }
 
 #endif
@@ -0,0 +1,445 @@
+#ifndef DURABLE_SUFFIX_TREE_HPP_
+# define DURABLE_SUFFIX_TREE_HPP_
+
+# include <string>
+# include <string_view>
+# include <filesystem>
+# include <fstream>
+# include <system_error>
+# include <stdexcept>
+# include <iterator>
+# include <utility>
+# include <cstdint>
+# include <cstring>
+# include <type_traits>
+
+# include <fcntl.h>
+# include <unistd.h>
+
+# include "CompressedSuffixTree.hpp"
+
+namespace container
+{
+    struct DurabilityOptions
+    {
+        size_t groupCommitSize = 64; // records buffered before a write
+        size_t fsyncInterval = 1; // writes between two fsync, 0 never syncs
+        size_t checkpointInterval = 0; // records between checkpoints, 0 disables
+    };
+
+    /* keeps a tree recoverable after a crash : every "insert" / "erase" is
+       appended to an operation log, and checkpoints write a snapshot of the
+       tree so that only the log written since the last one is replayed.
+
+       Files of the directory :
+         snapshot      -> generation number followed by the saved tree
+         log.<number>  -> operations applied after the snapshot of the same
+                          generation, each record ends with a checksum
+
+       Operations are durable once written and synced, i.e. after "sync", a
+       checkpoint, or when the group commit / fsync intervals are reached */
+    template <typename Tree = CompressedSuffixTree<>>
+    class DurableSuffixTree
+    {
+    public :
+        using mapped_type = typename Tree::mapped_type;
+
+    private :
+        using Value_t = std::conditional_t<
+            std::is_void_v<mapped_type>, std::nullptr_t, mapped_type>;
+
+    public :
+
+        explicit DurableSuffixTree(std::filesystem::path directory,
+                                   DurabilityOptions options = {}) :
+            _directory(std::move(directory)),
+            _options(options)
+        {
+            std::filesystem::create_directories(_directory);
+            recover();
+        }
+
+        DurableSuffixTree(const DurableSuffixTree&) = delete;
+        DurableSuffixTree& operator=(const DurableSuffixTree&) = delete;
+
+        ~DurableSuffixTree()
+        {
+            if (_fd != -1)
+            {
+                try
+                {
+                    flush(true);
+                }
+                catch (const std::system_error&)
+                {
+                    // records which couldn't be written are lost as after a crash
+                }
+
+                ::close(_fd);
+            }
+        }
+
+        [[nodiscard]]
+        inline const Tree& tree() const noexcept { return _tree; }
+
+        [[nodiscard]]
+        inline bool search(std::string_view word) const { return _tree.search(word); }
+
+        [[nodiscard]]
+        inline bool endsWith(std::string_view suffix) const
+        {
+            return _tree.endsWith(suffix);
+        }
+
+        // generation of the last checkpoint
+        [[nodiscard]]
+        inline std::uint64_t generation() const noexcept { return _generation; }
+
+        bool insert(std::string_view word)
+        {
+            if (word.empty())
+            {
+                return false;
+            }
+
+            // a duplicate still changes the frequency of the word
+            bool res = _tree.insert(word);
+
+            if constexpr (std::is_void_v<mapped_type>)
+            {
+                append(Operation::Insert, word, nullptr);
+            }
+            else
+            {
+                // replaying a default value is the same as not giving any
+                mapped_type value{};
+
+                append(Operation::Insert, word, &value);
+            }
+
+            return res;
+        }
+
+        template <typename V = mapped_type,
+                  std::enable_if_t<!std::is_void_v<V>, int> = 0>
+        bool insert(std::string_view word, Value_t value)
+        {
+            if (word.empty())
+            {
+                return false;
+            }
+
+            bool res = _tree.insert(word, value);
+
+            append(Operation::Insert, word, &value);
+
+            return res;
+        }
+
+        bool erase(std::string_view word)
+        {
+            if (!_tree.erase(word))
+            {
+                return false;
+            }
+
+            append(Operation::Erase, word, nullptr);
+
+            return true;
+        }
+
+        // writes and syncs buffered records
+        void sync()
+        {
+            flush(true);
+        }
+
+        /* saves the tree in a new snapshot, then starts a new log : a crash
+           at any point leaves either the old or the new generation usable */
+        void checkpoint()
+        {
+            auto generation = _generation + 1;
+            auto tmpPath = _directory / "snapshot.tmp";
+
+            {
+                std::ofstream ofs(tmpPath, std::ios::binary | std::ios::trunc);
+
+                ofs.write(reinterpret_cast<const char*>(&generation),
+                          sizeof(generation));
+                _tree.save(ofs);
+
+                if (!ofs.flush())
+                {
+                    throw std::system_error(
+                        errno, std::generic_category(), "cannot write snapshot");
+                }
+            }
+
+            syncPath(tmpPath);
+            std::filesystem::rename(tmpPath, _directory / "snapshot");
+            syncPath(_directory);
+
+            // records of the buffer are part of the snapshot
+            _buffer.clear();
+            _bufferedRecords = 0;
+            _recordsSinceCheckpoint = 0;
+            ::close(std::exchange(_fd, -1));
+            std::filesystem::remove(logPath(_generation));
+            _generation = generation;
+            openLog(0);
+        }
+
+    private :
+        enum class Operation : std::uint8_t
+        {
+            Insert = 1,
+            Erase = 2
+        };
+
+        static constexpr size_t valueSize = []
+        {
+            if constexpr (std::is_void_v<mapped_type>)
+            {
+                return 0;
+            }
+            else
+            {
+                static_assert(std::is_trivially_copyable_v<mapped_type>,
+                              "values must be trivially copyable to be logged");
+
+                return sizeof(mapped_type);
+            }
+        }();
+
+        std::filesystem::path _directory;
+        DurabilityOptions _options;
+        Tree _tree;
+        std::uint64_t _generation = 0;
+        int _fd = -1;
+        std::string _buffer;
+        size_t _bufferedRecords = 0;
+        size_t _unsyncedWrites = 0;
+        size_t _recordsSinceCheckpoint = 0;
+
+        [[nodiscard]]
+        std::filesystem::path logPath(std::uint64_t generation) const
+        {
+            return _directory / ("log." + std::to_string(generation));
+        }
+
+        [[nodiscard]]
+        static std::uint32_t checksum(std::string_view data) noexcept
+        {
+            // FNV-1a
+            std::uint32_t hash = 2166136261u;
+
+            for (unsigned char c : data)
+            {
+                hash = (hash ^ c) * 16777619u;
+            }
+
+            return hash;
+        }
+
+        static void syncPath(const std::filesystem::path& path)
+        {
+            int fd = ::open(path.c_str(), O_RDONLY);
+
+            if (fd == -1)
+            {
+                throw std::system_error(
+                    errno, std::generic_category(), "cannot open " + path.string());
+            }
+
+            int res = ::fsync(fd);
+            int error = errno;
+
+            ::close(fd);
+
+            if (res == -1)
+            {
+                throw std::system_error(
+                    error, std::generic_category(), "cannot sync " + path.string());
+            }
+        }
+
+        void recover()
+        {
+            if (std::ifstream ifs(_directory / "snapshot", std::ios::binary); ifs)
+            {
+                if (!ifs.read(reinterpret_cast<char*>(&_generation),
+                              sizeof(_generation))
+                    || !_tree.load(ifs))
+                {
+                    throw std::runtime_error("corrupted snapshot");
+                }
+            }
+
+            // logs of older generations are left over by an interrupted checkpoint
+            for (const auto& entry : std::filesystem::directory_iterator(_directory))
+            {
+                auto name = entry.path().filename().string();
+
+                if (name.rfind("log.", 0) == 0
+                    && name != logPath(_generation).filename().string())
+                {
+                    std::filesystem::remove(entry.path());
+                }
+            }
+
+            openLog(replay());
+        }
+
+        // returns the size of the valid part of the log
+        size_t replay()
+        {
+            std::ifstream ifs(logPath(_generation), std::ios::binary);
+            std::string data((std::istreambuf_iterator<char>(ifs)),
+                             std::istreambuf_iterator<char>());
+            size_t pos = 0;
+
+            for (;;)
+            {
+                constexpr size_t headerSize = 1 + sizeof(std::uint32_t);
+                std::uint32_t length = 0;
+                std::uint32_t sum = 0;
+
+                if (data.size() - pos < headerSize)
+                {
+                    break;
+                }
+
+                std::memcpy(&length, data.data() + pos + 1, sizeof(length));
+
+                // only insertions carry a value
+                size_t recordSize = headerSize + length
+                    + (data[pos] == static_cast<char>(Operation::Insert) ?
+                       valueSize : 0);
+
+                if (data.size() - pos < recordSize + sizeof(sum))
+                {
+                    break;
+                }
+
+                std::memcpy(&sum, data.data() + pos + recordSize, sizeof(sum));
+
+                auto record = std::string_view(data).substr(pos, recordSize);
+
+                if (sum != checksum(record) || length == 0)
+                {
+                    break;
+                }
+
+                apply(static_cast<Operation>(record[0]),
+                      record.substr(headerSize, length),
+                      record.data() + headerSize + length);
+                pos += recordSize + sizeof(sum);
+            }
+
+            // anything after the last valid record is a torn write
+            return pos;
+        }
+
+        void apply(Operation operation, std::string_view word, const char* value)
+        {
+            if (operation == Operation::Erase)
+            {
+                _tree.erase(word);
+            }
+            else if constexpr (std::is_void_v<mapped_type>)
+            {
+                _tree.insert(word);
+            }
+            else
+            {
+                mapped_type v;
+
+                std::memcpy(&v, value, sizeof(v));
+                _tree.insert(word, v);
+            }
+        }
+
+        void openLog(size_t validSize)
+        {
+            auto path = logPath(_generation);
+
+            _fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+
+            if (_fd == -1 || ::ftruncate(_fd, validSize) == -1)
+            {
+                throw std::system_error(
+                    errno, std::generic_category(), "cannot open " + path.string());
+            }
+        }
+
+        void append(Operation operation, std::string_view word, const void* value)
+        {
+            auto begin = _buffer.size();
+            auto length = static_cast<std::uint32_t>(word.size());
+
+            _buffer.push_back(static_cast<char>(operation));
+            _buffer.append(reinterpret_cast<const char*>(&length), sizeof(length));
+            _buffer.append(word);
+
+            if (value)
+            {
+                _buffer.append(static_cast<const char*>(value), valueSize);
+            }
+
+            auto sum = checksum(std::string_view(_buffer).substr(begin));
+
+            _buffer.append(reinterpret_cast<const char*>(&sum), sizeof(sum));
+            ++_recordsSinceCheckpoint;
+
+            if (_options.checkpointInterval
+                && _recordsSinceCheckpoint >= _options.checkpointInterval)
+            {
+                checkpoint();
+            }
+            else if (++_bufferedRecords >= _options.groupCommitSize)
+            {
+                flush(false);
+            }
+        }
+
+        void flush(bool forceSync)
+        {
+            if (!_buffer.empty())
+            {
+                for (size_t pos = 0; pos < _buffer.size();)
+                {
+                    auto n = ::write(_fd, _buffer.data() + pos, _buffer.size() - pos);
+
+                    if (n == -1)
+                    {
+                        throw std::system_error(
+                            errno, std::generic_category(), "cannot write log");
+                    }
+
+                    pos += n;
+                }
+
+                _buffer.clear();
+                _bufferedRecords = 0;
+                ++_unsyncedWrites;
+            }
+
+            if (_unsyncedWrites
+                && (forceSync
+                    || (_options.fsyncInterval
+                        && _unsyncedWrites >= _options.fsyncInterval)))
+            {
+                // the writes stay unsynced, the next flush tries again
+                if (::fsync(_fd) == -1)
+                {
+                    throw std::system_error(
+                        errno, std::generic_category(), "cannot sync log");
+                }
+
+                _unsyncedWrites = 0;
+            }
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,462 @@
+#ifndef EXTERNAL_SUFFIX_TREE_HPP_
+# define EXTERNAL_SUFFIX_TREE_HPP_
+
+# include <vector>
+# include <map>
+# include <set>
+# include <string>
+# include <string_view>
+# include <filesystem>
+# include <fstream>
+# include <memory>
+# include <algorithm>
+# include <limits>
+# include <system_error>
+# include <stdexcept>
+# include <cstdint>
+# include <cstring>
+# include <cerrno>
+
+# include "CompressedSuffixTree.hpp"
+
+namespace container
+{
+    struct ExternalBuildOptions
+    {
+        size_t memoryBudget = size_t(1) << 30; // bytes for the tree of a partition
+        size_t bytesPerSuffix = 256; // estimated cost of a suffix in a tree, characters excluded
+        size_t maxPrefixLength = 32; // partitions aren't refined beyond
+        size_t maxOpenFiles = 64; // bucket files written at once
+    };
+
+    namespace detail
+    {
+        inline constexpr char externalManifestMagic[8] = {'C', 'S', 'T', 'X', 'M', 'F', '0', '1'};
+
+        template <typename T>
+        void writeExternal(std::ostream& os, const T& value)
+        {
+            os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        template <typename T>
+        bool readExternal(std::istream& is, T& value)
+        {
+            return static_cast<bool>(
+                is.read(reinterpret_cast<char*>(&value), sizeof(value)));
+        }
+
+        inline void writeString(std::ostream& os, std::string_view s)
+        {
+            writeExternal(os, static_cast<std::uint32_t>(s.size()));
+            os.write(s.data(), s.size());
+        }
+
+        inline bool readString(std::istream& is, std::string& s)
+        {
+            std::uint32_t size = 0;
+
+            if (!readExternal(is, size))
+            {
+                return false;
+            }
+
+            s.resize(size);
+
+            return static_cast<bool>(is.read(s.data(), size));
+        }
+
+        inline void checkStream(const std::ios& stream, const std::filesystem::path& path)
+        {
+            if (!stream)
+            {
+                throw std::system_error(
+                    errno, std::generic_category(), "cannot write " + path.string());
+            }
+        }
+
+        inline std::filesystem::path partitionPath(const std::filesystem::path& directory,
+                                                   size_t n)
+        {
+            return directory / ("partition." + std::to_string(n));
+        }
+
+        // first partition whose suffixes may be equal to s
+        [[nodiscard]]
+        inline size_t partitionOf(const std::vector<std::string>& bounds,
+                                  std::string_view s) noexcept
+        {
+            auto it = std::upper_bound(bounds.cbegin(), bounds.cend(), s,
+                                       [](std::string_view lhs, const std::string& rhs)
+                                       {
+                                           return lhs < rhs;
+                                       });
+
+            return (it == bounds.cbegin()) ? 0 : it - bounds.cbegin() - 1;
+        }
+    }
+
+    /* builds an index of words larger than the memory : words are streamed
+       to a temporary file, suffixes are split in lexicographic ranges by
+       prefixes long enough for the tree of each range to fit in the memory
+       budget, then each range is built and saved on its own.
+
+       Files of the directory :
+         manifest     -> lower bound of the suffixes of each partition
+         partition.n  -> saved tree of the suffixes of the n-th partition
+       Temporary files (words.tmp, bucket.n.tmp) are removed by "finish".
+       Words are stored normalized by the policy of Tree, so that suffixes are
+       partitioned as the queries are routed. Their original spellings and
+       their frequencies aren't kept */
+    template <typename Tree = CompressedSuffixTree<>>
+    class ExternalSuffixTreeBuilder
+    {
+    public :
+        explicit ExternalSuffixTreeBuilder(std::filesystem::path directory,
+                                           ExternalBuildOptions options = {}) :
+            _directory(std::move(directory)),
+            _options(options)
+        {
+            std::filesystem::create_directories(_directory);
+            _words.open(wordsPath(), std::ios::binary | std::ios::trunc);
+            detail::checkStream(_words, wordsPath());
+        }
+
+        // false for an empty word
+        bool add(std::string_view word)
+        {
+            std::string buffer;
+
+            word = detail::TreeAccess::normalizedKey<Tree>(word, buffer);
+
+            if (word.empty())
+            {
+                return false;
+            }
+
+            if (word.size() > std::numeric_limits<std::uint32_t>::max())
+            {
+                throw std::length_error("word too long to be indexed");
+            }
+
+            detail::writeString(_words, word);
+            detail::checkStream(_words, wordsPath());
+            ++_wordCount;
+
+            return true;
+        }
+
+        // writes the partitions and the manifest, returns the number of partitions
+        size_t finish()
+        {
+            _words.close();
+            detail::checkStream(_words, wordsPath());
+
+            auto bounds = partitionBounds(countSuffixes());
+            auto step = std::max<size_t>(_options.maxOpenFiles, 1);
+
+            for (size_t first = 0; first < bounds.size(); first += step)
+            {
+                size_t last = std::min(first + step, bounds.size());
+
+                distribute(bounds, first, last);
+
+                for (size_t n = first; n < last; ++n)
+                {
+                    buildPartition(n);
+                }
+            }
+
+            writeManifest(bounds);
+            std::filesystem::remove(wordsPath());
+
+            return bounds.size();
+        }
+
+    private :
+        std::filesystem::path _directory;
+        ExternalBuildOptions _options;
+        std::ofstream _words;
+        size_t _wordCount = 0;
+
+        [[nodiscard]]
+        inline std::filesystem::path wordsPath() const { return _directory / "words.tmp"; }
+
+        [[nodiscard]]
+        inline std::filesystem::path bucketPath(size_t n) const
+        {
+            return _directory / ("bucket." + std::to_string(n) + ".tmp");
+        }
+
+        [[nodiscard]]
+        inline size_t cost(std::string_view suffix) const noexcept
+        {
+            return _options.bytesPerSuffix + suffix.size();
+        }
+
+        // calls f(suffix, isWord) for each suffix of the stored words
+        template <typename F>
+        void forEachSuffix(F f) const
+        {
+            std::ifstream ifs(wordsPath(), std::ios::binary);
+            std::string word;
+
+            for (size_t n = 0; n < _wordCount; ++n)
+            {
+                if (!detail::readString(ifs, word))
+                {
+                    throw std::runtime_error("corrupted " + wordsPath().string());
+                }
+
+                for (size_t m = 0; m < word.size(); ++m)
+                {
+                    f(std::string_view(word).substr(m), m == 0);
+                }
+            }
+        }
+
+        /* cost of the suffixes grouped by prefix : groups over the budget are
+           refined on one more character, each pass reading the words again.
+           A suffix shorter than a refined prefix stays in the group of its
+           whole string, which is ordered before the longer prefixes */
+        std::map<std::string, size_t, std::less<>> countSuffixes() const
+        {
+            std::map<std::string, size_t, std::less<>> groups;
+
+            forEachSuffix([&](std::string_view suffix, bool)
+            {
+                groups[std::string(suffix.substr(0, 1))] += cost(suffix);
+            });
+
+            for (size_t length = 1; length < _options.maxPrefixLength; ++length)
+            {
+                std::set<std::string, std::less<>> refined;
+
+                for (auto it = groups.begin(); it != groups.end();)
+                {
+                    if (it->first.size() == length && it->second > _options.memoryBudget)
+                    {
+                        refined.insert(it->first);
+                        it = groups.erase(it);
+                    }
+                    else
+                    {
+                        ++it;
+                    }
+                }
+
+                if (refined.empty())
+                {
+                    break;
+                }
+
+                forEachSuffix([&](std::string_view suffix, bool)
+                {
+                    if (suffix.size() >= length && refined.count(suffix.substr(0, length)))
+                    {
+                        groups[std::string(suffix.substr(0, length + 1))] += cost(suffix);
+                    }
+                });
+            }
+
+            return groups;
+        }
+
+        // consecutive groups within the budget share a partition
+        std::vector<std::string> partitionBounds(
+            const std::map<std::string, size_t, std::less<>>& groups) const
+        {
+            std::vector<std::string> res = {""};
+            size_t total = 0;
+
+            for (const auto& [prefix, groupCost] : groups)
+            {
+                if (total > 0 && total + groupCost > _options.memoryBudget)
+                {
+                    res.push_back(prefix);
+                    total = 0;
+                }
+
+                total += groupCost;
+            }
+
+            return res;
+        }
+
+        // writes the suffixes of the partitions [first, last) to their bucket
+        void distribute(const std::vector<std::string>& bounds, size_t first, size_t last)
+        {
+            std::vector<std::ofstream> buckets;
+
+            for (size_t n = first; n < last; ++n)
+            {
+                buckets.emplace_back(bucketPath(n), std::ios::binary | std::ios::trunc);
+                detail::checkStream(buckets.back(), bucketPath(n));
+            }
+
+            forEachSuffix([&](std::string_view suffix, bool isWord)
+            {
+                auto n = detail::partitionOf(bounds, suffix);
+
+                if (n >= first && n < last)
+                {
+                    auto& bucket = buckets[n - first];
+
+                    bucket.put(isWord ? 1 : 0);
+                    detail::writeString(bucket, suffix);
+                }
+            });
+
+            for (size_t n = first; n < last; ++n)
+            {
+                buckets[n - first].close();
+                detail::checkStream(buckets[n - first], bucketPath(n));
+            }
+        }
+
+        void buildPartition(size_t n)
+        {
+            Tree tree;
+
+            {
+                std::ifstream ifs(bucketPath(n), std::ios::binary);
+                std::string suffix;
+                char isWord = 0;
+
+                while (ifs.get(isWord))
+                {
+                    if (!detail::readString(ifs, suffix))
+                    {
+                        throw std::runtime_error("corrupted " + bucketPath(n).string());
+                    }
+
+                    detail::TreeAccess::insertSuffix(tree, suffix, isWord != 0);
+                }
+            }
+
+            std::ofstream ofs(detail::partitionPath(_directory, n),
+                              std::ios::binary | std::ios::trunc);
+
+            tree.save(ofs);
+            ofs.close();
+            detail::checkStream(ofs, detail::partitionPath(_directory, n));
+            std::filesystem::remove(bucketPath(n));
+        }
+
+        void writeManifest(const std::vector<std::string>& bounds) const
+        {
+            auto path = _directory / "manifest";
+            std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+
+            ofs.write(detail::externalManifestMagic, sizeof(detail::externalManifestMagic));
+            detail::writeExternal(ofs, static_cast<std::uint64_t>(_wordCount));
+            detail::writeExternal(ofs, static_cast<std::uint64_t>(bounds.size()));
+
+            for (const auto& bound : bounds)
+            {
+                detail::writeString(ofs, bound);
+            }
+
+            ofs.close();
+            detail::checkStream(ofs, path);
+        }
+    };
+
+    /* queries an index written by ExternalSuffixTreeBuilder : a query only
+       needs the partition of its suffix range, which is loaded on demand and
+       kept until another one is needed. Queries are not thread-safe */
+    template <typename Tree = CompressedSuffixTree<>>
+    class ExternalSuffixTree
+    {
+    public :
+        explicit ExternalSuffixTree(std::filesystem::path directory) :
+            _directory(std::move(directory))
+        {
+            std::ifstream ifs(_directory / "manifest", std::ios::binary);
+            char magic[sizeof(detail::externalManifestMagic)] = {};
+            std::uint64_t wordCount = 0;
+            std::uint64_t count = 0;
+
+            if (!ifs.read(magic, sizeof(magic))
+                || std::memcmp(magic, detail::externalManifestMagic, sizeof(magic)) != 0
+                || !detail::readExternal(ifs, wordCount)
+                || !detail::readExternal(ifs, count))
+            {
+                throw std::runtime_error("corrupted manifest");
+            }
+
+            _wordCount = wordCount;
+            _bounds.resize(count);
+
+            for (auto& bound : _bounds)
+            {
+                if (!detail::readString(ifs, bound))
+                {
+                    throw std::runtime_error("corrupted manifest");
+                }
+            }
+        }
+
+        [[nodiscard]]
+        inline size_t partitionCount() const noexcept { return _bounds.size(); }
+
+        // number of words given to the builder
+        [[nodiscard]]
+        inline size_t wordCount() const noexcept { return _wordCount; }
+
+        [[nodiscard]]
+        bool search(std::string_view word) const
+        {
+            return !word.empty() && partition(partitionOf(word)).search(word);
+        }
+
+        [[nodiscard]]
+        bool endsWith(std::string_view suffix) const
+        {
+            return !suffix.empty() && partition(partitionOf(suffix)).endsWith(suffix);
+        }
+
+        // loads the n-th partition, which stays valid until another one is loaded
+        const Tree& partition(size_t n) const
+        {
+            if (n != _loaded)
+            {
+                std::ifstream ifs(detail::partitionPath(_directory, n), std::ios::binary);
+
+                _tree.clear();
+                _loaded = npos;
+
+                if (!_tree.load(ifs))
+                {
+                    throw std::runtime_error(
+                        "corrupted " + detail::partitionPath(_directory, n).string());
+                }
+
+                _loaded = n;
+            }
+
+            return _tree;
+        }
+
+        // partition of the suffixes equal to s once normalized
+        [[nodiscard]]
+        size_t partitionOf(std::string_view s) const
+        {
+            std::string buffer;
+
+            return detail::partitionOf(
+                _bounds, detail::TreeAccess::normalizedKey<Tree>(s, buffer));
+        }
+
+    private :
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+        std::filesystem::path _directory;
+        std::vector<std::string> _bounds;
+        size_t _wordCount = 0;
+        mutable Tree _tree;
+        mutable size_t _loaded = npos;
+    };
+}
+
+#endif
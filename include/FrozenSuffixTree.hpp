@@ -0,0 +1,1127 @@
+#ifndef FROZEN_SUFFIX_TREE_HPP_
+# define FROZEN_SUFFIX_TREE_HPP_
+
+# include <vector>
+# include <string>
+# include <string_view>
+# include <unordered_map>
+# include <algorithm>
+# include <limits>
+# include <tuple>
+# include <utility>
+# include <stdexcept>
+# include <cstdint>
+# include <cstddef>
+
+# include "CompressedSuffixTree.hpp"
+
+namespace container
+{
+    namespace detail
+    {
+        /* index of the minimum of any range of an array, in O(n) space : the
+           array is cut in blocks of 32 values, a sparse table gives the
+           minimum of any range of blocks and each value keeps the positions
+           of the minimums of the suffixes of its block ending at it (the
+           stack of increasing values, as a mask). Ties go to the first one */
+        class RangeMinimum
+        {
+        public :
+            RangeMinimum() = default;
+
+            explicit RangeMinimum(std::vector<std::uint32_t> values) :
+                _values(std::move(values)),
+                _masks(_values.size())
+            {
+                if (_values.empty())
+                {
+                    return;
+                }
+
+                std::uint32_t mask = 0;
+
+                for (size_t n = 0; n < _values.size(); ++n)
+                {
+                    auto blockStart = n - n % blockSize;
+
+                    mask = (n == blockStart) ? 0 : mask;
+
+                    // values after a smaller one are never the minimum of a range holding both
+                    while (mask && _values[blockStart + highestBit(mask)] > _values[n])
+                    {
+                        mask &= ~(std::uint32_t(1) << highestBit(mask));
+                    }
+
+                    mask |= std::uint32_t(1) << (n - blockStart);
+                    _masks[n] = mask;
+                }
+
+                auto blockCount = (_values.size() + blockSize - 1) / blockSize;
+
+                _levels.emplace_back(blockCount);
+
+                for (size_t n = 0; n < blockCount; ++n)
+                {
+                    _levels[0][n] = inBlock(n * blockSize,
+                                            std::min(_values.size(), (n + 1) * blockSize) - 1);
+                }
+
+                for (size_t width = 2; width <= blockCount; width *= 2)
+                {
+                    const auto& previous = _levels.back();
+                    std::vector<std::uint32_t> level(blockCount - width + 1);
+
+                    for (size_t n = 0; n < level.size(); ++n)
+                    {
+                        level[n] = min(previous[n], previous[n + width / 2]);
+                    }
+
+                    _levels.push_back(std::move(level));
+                }
+            }
+
+            [[nodiscard]]
+            inline std::uint32_t value(size_t n) const noexcept { return _values[n]; }
+
+            // index of the minimum within [begin, end), which must not be empty
+            [[nodiscard]]
+            std::uint32_t argmin(size_t begin, size_t end) const noexcept
+            {
+                auto last = end - 1;
+                auto firstBlock = begin / blockSize;
+                auto lastBlock = last / blockSize;
+
+                if (firstBlock == lastBlock)
+                {
+                    return inBlock(begin, last);
+                }
+
+                auto res = inBlock(begin, firstBlock * blockSize + blockSize - 1);
+
+                if (firstBlock + 1 < lastBlock)
+                {
+                    res = min(res, blocks(firstBlock + 1, lastBlock));
+                }
+
+                return min(res, inBlock(lastBlock * blockSize, last));
+            }
+
+            [[nodiscard]]
+            size_t memoryUsage() const noexcept
+            {
+                size_t res = (_values.capacity() + _masks.capacity()) * sizeof(std::uint32_t);
+
+                for (const auto& level : _levels)
+                {
+                    res += level.capacity() * sizeof(std::uint32_t);
+                }
+
+                return res;
+            }
+
+        private :
+            static constexpr size_t blockSize = 32;
+
+            std::vector<std::uint32_t> _values;
+            std::vector<std::uint32_t> _masks;
+            std::vector<std::vector<std::uint32_t>> _levels; // of blocks
+
+            [[nodiscard]]
+            static inline size_t highestBit(std::uint32_t mask) noexcept
+            {
+                return 31 - static_cast<size_t>(__builtin_clz(mask));
+            }
+
+            [[nodiscard]]
+            inline std::uint32_t min(std::uint32_t lhs, std::uint32_t rhs) const noexcept
+            {
+                return (_values[rhs] < _values[lhs]) ? rhs : lhs;
+            }
+
+            // within the block of last, first of the stack at or after begin
+            [[nodiscard]]
+            inline std::uint32_t inBlock(size_t begin, size_t last) const noexcept
+            {
+                auto blockStart = last - last % blockSize;
+                auto mask = _masks[last] & (~std::uint32_t(0) << (begin - blockStart));
+
+                return static_cast<std::uint32_t>(blockStart + __builtin_ctz(mask));
+            }
+
+            // blocks within [begin, end)
+            [[nodiscard]]
+            std::uint32_t blocks(size_t begin, size_t end) const noexcept
+            {
+                size_t level = 0;
+
+                while ((size_t(2) << level) <= end - begin)
+                {
+                    ++level;
+                }
+
+                return min(_levels[level][begin], _levels[level][end - (size_t(1) << level)]);
+            }
+        };
+    }
+
+    struct FreezeOptions
+    {
+        bool indexDocuments = false; // see documentCount and documents
+        /* first characters of the queries looked up in a table giving the
+           node reached after them, 0 to 3 (table of 256^jumpLength entries) */
+        size_t jumpLength = 0;
+        // see maximalExactMatches, implies indexDocuments
+        bool indexMatches = false;
+    };
+
+    /* query[queryPosition, queryPosition + length) equals
+       word[wordPosition, wordPosition + length) */
+    struct ExactMatch
+    {
+        size_t queryPosition = 0;
+        std::string_view word;
+        size_t wordPosition = 0;
+        size_t length = 0;
+    };
+
+    /* read-only copy of a tree in a few contiguous arrays : nodes are stored
+       breadth first so that the children of a node are adjacent and sorted
+       by their first character, all edge labels share a single string.
+       Queries are normalized by the same policy as the source tree.
+
+       When built with FreezeOptions::indexDocuments, each stored word is a document and
+       the distinct words containing a substring are counted in O(m) (Hui's
+       color set size, with LCA corrections between the occurrences of a
+       word in pre-order) and listed in O(m + ndoc) (Muthukrishnan's
+       document listing over the previous occurrence of each word).
+
+       FreezeOptions::indexMatches also keeps the string depth and the suffix
+       link of each node, so that a query is matched against all the words in
+       one pass (matching statistics of Chang and Lawler) to find its maximal
+       exact and unique matches with them, as the seeds of MUMmer */
+    template <typename Normalizer = normalization::Identity>
+    class FrozenSuffixTree
+    {
+    public :
+        FrozenSuffixTree() = default;
+
+        template <template <typename...> typename Alloc,
+                  typename Value,
+                  typename Instrumentation>
+        explicit FrozenSuffixTree(
+            const CompressedSuffixTree<Alloc, Value, Instrumentation, Normalizer>& tree,
+            FreezeOptions options = {}) :
+            _wordCount(tree.wordCount())
+        {
+            if (options.jumpLength > maxJumpLength)
+            {
+                throw std::length_error("jump table too large");
+            }
+
+            build(detail::TreeAccess::root(tree));
+
+            _matchesIndexed = options.indexMatches;
+
+            if (options.indexDocuments || options.indexMatches)
+            {
+                // the suffix links lead from each suffix of a word to the next one
+                _documentsIndexed = true;
+                buildSuffixLinks();
+                buildDocuments(tree.cbegin(), tree.cend());
+            }
+
+            // only kept for the matches
+            if (!_matchesIndexed)
+            {
+                _parents.clear();
+                _parents.shrink_to_fit();
+                _depths.clear();
+                _depths.shrink_to_fit();
+                _links.clear();
+                _links.shrink_to_fit();
+            }
+
+            if (options.jumpLength > 0 && !_nodes.empty())
+            {
+                _jumpLength = options.jumpLength;
+                buildJumpTable();
+            }
+        }
+
+        [[nodiscard]]
+        inline bool empty() const noexcept { return _nodes.size() <= 1; }
+
+        // number of nodes, root excluded as for CompressedSuffixTree
+        [[nodiscard]]
+        inline size_t size() const noexcept
+        {
+            return _nodes.empty() ? 0 : _nodes.size() - 1;
+        }
+
+        [[nodiscard]]
+        inline size_t wordCount() const noexcept { return _wordCount; }
+
+        // bytes used by the arrays
+        [[nodiscard]]
+        size_t memoryUsage() const noexcept
+        {
+            return _nodes.capacity() * sizeof(Node)
+                + _firstChars.capacity()
+                + _labels.capacity()
+                + _documentText.capacity()
+                + (_documentOffsets.capacity() + _documentCounts.capacity()
+                   + _occurrenceRanges.capacity() * 2 + _occurrenceDocuments.capacity())
+                  * sizeof(std::uint32_t)
+                + _previousOccurrences.memoryUsage()
+                + _jumpTable.capacity() * sizeof(JumpEntry)
+                + (_occurrenceOffsets.capacity() + _parents.capacity() + _depths.capacity())
+                  * sizeof(std::uint32_t)
+                + _links.capacity() * sizeof(Locus);
+        }
+
+        // number of characters indexed by the jump table, 0 without table
+        [[nodiscard]]
+        inline size_t jumpLength() const noexcept { return _jumpLength; }
+
+        [[nodiscard]]
+        inline bool hasDocuments() const noexcept { return _documentsIndexed; }
+
+        [[nodiscard]]
+        inline bool hasMatches() const noexcept { return _matchesIndexed; }
+
+        // number of distinct stored words containing the pattern
+        [[nodiscard]]
+        size_t documentCount(std::string_view pattern) const
+        {
+            assertm(hasDocuments(), "documents must be indexed");
+
+            auto node = locus(pattern);
+
+            return (node == npos) ? 0 : _documentCounts[node];
+        }
+
+        // distinct stored words containing the pattern, in no particular order
+        [[nodiscard]]
+        std::vector<std::string_view> documents(std::string_view pattern) const
+        {
+            assertm(hasDocuments(), "documents must be indexed");
+
+            std::vector<std::string_view> res;
+            auto node = locus(pattern);
+
+            if (node == npos)
+            {
+                return res;
+            }
+
+            auto [first, last] = _occurrenceRanges[node];
+            std::vector<std::pair<std::uint32_t, std::uint32_t>> ranges;
+
+            res.reserve(_documentCounts[node]);
+
+            /* an occurrence whose previous occurrence of the same word is
+               before "first" is the first one of its word in the range, the
+               minimum of a range is such an occurrence if any */
+            if (first < last)
+            {
+                ranges.emplace_back(first, last);
+            }
+
+            while (!ranges.empty())
+            {
+                auto [begin, end] = ranges.back();
+
+                ranges.pop_back();
+
+                auto n = _previousOccurrences.argmin(begin, end);
+
+                if (_previousOccurrences.value(n) > first)
+                {
+                    continue;
+                }
+
+                res.push_back(document(_occurrenceDocuments[n]));
+
+                if (begin < n)
+                {
+                    ranges.emplace_back(begin, n);
+                }
+
+                if (n + 1 < end)
+                {
+                    ranges.emplace_back(n + 1, end);
+                }
+            }
+
+            return res;
+        }
+
+        /* length of the longest prefix of each suffix of the normalized query
+           found in a word, in O(m) */
+        [[nodiscard]]
+        std::vector<size_t> matchingStatistics(std::string_view query) const
+        {
+            assertm(hasMatches(), "matches must be indexed");
+
+            std::string buffer;
+            auto normalizedQuery = normalize(query, buffer);
+            std::vector<size_t> res(normalizedQuery.size());
+
+            matchSuffixes(normalizedQuery, [&](size_t n, const Locus&, size_t length)
+            {
+                res[n] = length;
+            });
+
+            return res;
+        }
+
+        /* calls sink(const ExactMatch&) for each match of at least minLength
+           characters between the normalized query and a word that can be
+           extended neither to the left nor to the right, by increasing query
+           position. O(m + r) where r is the number of matches of at least
+           minLength characters which can't be extended to the right */
+        template <typename Sink>
+        void maximalExactMatches(std::string_view query, size_t minLength, Sink&& sink) const
+        {
+            assertm(hasMatches(), "matches must be indexed");
+
+            std::string buffer;
+            auto normalizedQuery = normalize(query, buffer);
+
+            minLength = std::max<size_t>(minLength, 1);
+
+            matchSuffixes(normalizedQuery, [&](size_t n, const Locus& locus, size_t length)
+            {
+                if (length < minLength)
+                {
+                    return;
+                }
+
+                auto [begin, end] = _occurrenceRanges[locus.node];
+
+                // the matches below the locus are as long as the statistic
+                reportMatches(normalizedQuery, n, begin, end, length, sink);
+
+                // above, they end at a node, where the other branches differ from the query
+                for (auto node = locus.node; node != 0;)
+                {
+                    auto parent = _parents[node];
+
+                    if (parent == 0 || _depths[parent] < minLength)
+                    {
+                        break;
+                    }
+
+                    auto [parentBegin, parentEnd] = _occurrenceRanges[parent];
+                    auto [childBegin, childEnd] = _occurrenceRanges[node];
+
+                    reportMatches(normalizedQuery, n, parentBegin, childBegin,
+                                  _depths[parent], sink);
+                    reportMatches(normalizedQuery, n, childEnd, parentEnd,
+                                  _depths[parent], sink);
+                    node = parent;
+                }
+            });
+        }
+
+        /* calls sink(const ExactMatch&) for each maximal exact match of at
+           least minLength characters occurring once in the normalized query
+           and once in all the words, by increasing query position */
+        template <typename Sink>
+        void maximalUniqueMatches(std::string_view query, size_t minLength, Sink&& sink) const
+        {
+            assertm(hasMatches(), "matches must be indexed");
+
+            std::string buffer;
+            auto normalizedQuery = normalize(query, buffer);
+            // longest suffix of the query matching each unique occurrence, and whether it is alone
+            std::unordered_map<std::uint32_t, std::tuple<size_t, size_t, bool>> best;
+
+            minLength = std::max<size_t>(minLength, 1);
+
+            /* another suffix of the query reaching the same unique occurrence
+               at least as far contains the match too */
+            matchSuffixes(normalizedQuery, [&](size_t n, const Locus& locus, size_t length)
+            {
+                auto [begin, end] = _occurrenceRanges[locus.node];
+
+                if (length < minLength || end - begin != 1)
+                {
+                    return;
+                }
+
+                auto [it, inserted] = best.try_emplace(begin, length, n, true);
+                auto& [bestLength, position, alone] = it->second;
+
+                if (inserted)
+                {
+                    return;
+                }
+
+                if (length > bestLength)
+                {
+                    it->second = {length, n, true};
+                }
+                else if (length == bestLength)
+                {
+                    alone = false;
+                }
+            });
+
+            std::vector<ExactMatch> res;
+
+            for (const auto& [occurrence, candidate] : best)
+            {
+                auto [length, position, alone] = candidate;
+
+                if (alone && leftMaximal(normalizedQuery, position, occurrence))
+                {
+                    res.push_back(exactMatch(position, occurrence, length));
+                }
+            }
+
+            std::sort(res.begin(), res.end(),
+                      [](const ExactMatch& lhs, const ExactMatch& rhs)
+                      {
+                          return lhs.queryPosition < rhs.queryPosition;
+                      });
+
+            for (const auto& match : res)
+            {
+                sink(match);
+            }
+        }
+
+        [[nodiscard]]
+        bool search(std::string_view word) const
+        {
+            auto node = locate(word);
+
+            return node != npos && _nodes[node].terminalWord;
+        }
+
+        [[nodiscard]]
+        bool endsWith(std::string_view suffix) const
+        {
+            auto node = locate(suffix);
+
+            return node != npos
+                && _nodes[node].terminalCount > (_nodes[node].terminalWord ? 1 : 0);
+        }
+
+    private :
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+        struct Node
+        {
+            std::uint32_t label = 0; // offset of the label in _labels
+            std::uint32_t length = 0;
+            std::uint32_t firstChild = 0;
+            std::uint32_t childCount = 0;
+            std::int32_t terminalCount = 0;
+            bool terminalWord = false;
+        };
+
+        std::vector<Node> _nodes; // breadth first, the root first
+        std::vector<char> _firstChars; // first character of each label, scanned for children
+        std::string _labels;
+        size_t _wordCount = 0;
+
+        /* locus after each string of _jumpLength characters, the key being
+           their big endian value : node and characters of its label read */
+        static constexpr size_t maxJumpLength = 3;
+        static constexpr std::uint32_t noJump = static_cast<std::uint32_t>(-1);
+
+        using JumpEntry = std::pair<std::uint32_t, std::uint32_t>;
+
+        size_t _jumpLength = 0;
+        std::vector<JumpEntry> _jumpTable;
+
+        // empty unless documents are indexed
+        bool _documentsIndexed = false;
+        std::string _documentText; // stored words, concatenated
+        std::vector<std::uint32_t> _documentOffsets; // word n is between offsets n and n + 1
+        std::vector<std::uint32_t> _documentCounts; // distinct words below each node
+        // range of the occurrences below each node
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> _occurrenceRanges;
+        // suffixes of the words ordered by the pre-order of their node
+        std::vector<std::uint32_t> _occurrenceDocuments;
+        // previous occurrence of the same word plus 1, 0 when there is none
+        detail::RangeMinimum _previousOccurrences;
+
+        // position in a label : the first "offset" characters of the node are read
+        struct Locus
+        {
+            std::uint32_t node = 0;
+            std::uint32_t offset = 0;
+        };
+
+        // empty unless matches are indexed
+        bool _matchesIndexed = false;
+        std::vector<std::uint32_t> _occurrenceOffsets; // position of each occurrence in its word
+        std::vector<std::uint32_t> _parents;
+        std::vector<std::uint32_t> _depths; // length of the path up to the end of each node
+        std::vector<Locus> _links; // locus of the path of each node without its first character
+
+        [[nodiscard]]
+        inline std::string_view document(size_t n) const noexcept
+        {
+            return std::string_view(_documentText).substr(
+                _documentOffsets[n], _documentOffsets[n + 1] - _documentOffsets[n]);
+        }
+
+        // the query itself when nothing is normalized
+        [[nodiscard]]
+        static std::string_view normalize(std::string_view query, std::string& buffer)
+        {
+            if constexpr (Normalizer::identity)
+            {
+                return query;
+            }
+            else
+            {
+                typename Normalizer::Reader reader(query);
+
+                while (!reader.empty())
+                {
+                    buffer.push_back(reader.get());
+                }
+
+                return buffer;
+            }
+        }
+
+        /* reads s from a locus, s being known to follow it in the tree (skip
+           and count : only the first character of each node is compared) */
+        [[nodiscard]]
+        Locus skip(Locus locus, std::string_view s) const noexcept
+        {
+            while (!s.empty())
+            {
+                if (locus.offset == _nodes[locus.node].length)
+                {
+                    locus.node = static_cast<std::uint32_t>(findChild(locus.node, s[0]));
+                    locus.offset = 0;
+                    assertm(locus.node != npos, "the string must be in the tree");
+                }
+
+                auto length = std::min<size_t>(s.size(),
+                                               _nodes[locus.node].length - locus.offset);
+
+                locus.offset += static_cast<std::uint32_t>(length);
+                s.remove_prefix(length);
+            }
+
+            return locus;
+        }
+
+        void buildSuffixLinks()
+        {
+            if (_nodes.empty())
+            {
+                return;
+            }
+
+            _parents.assign(_nodes.size(), 0);
+            _depths.assign(_nodes.size(), 0);
+            _links.assign(_nodes.size(), Locus{});
+
+            // parents come before their children in breadth first order
+            for (size_t n = 0; n < _nodes.size(); ++n)
+            {
+                for (size_t m = 0; m < _nodes[n].childCount; ++m)
+                {
+                    auto child = _nodes[n].firstChild + m;
+
+                    _parents[child] = static_cast<std::uint32_t>(n);
+                    _depths[child] = _depths[n] + _nodes[child].length;
+                }
+
+                if (n == 0)
+                {
+                    continue;
+                }
+
+                std::string_view label(_labels.data() + _nodes[n].label, _nodes[n].length);
+
+                _links[n] = (_parents[n] == 0) ?
+                    skip(Locus{}, label.substr(1)) : skip(_links[_parents[n]], label);
+            }
+        }
+
+        // node of the path of a node without its first character, which must be a node
+        [[nodiscard]]
+        inline size_t linkedNode(size_t node) const noexcept
+        {
+            assertm(_links[node].offset == _nodes[_links[node].node].length,
+                    "the suffix of a path must end at a node");
+
+            return _links[node].node;
+        }
+
+        /* calls f(n, locus, length) with the locus of the longest prefix of
+           each suffix of the query found in the tree. From one suffix to the
+           next, the suffix link of the deepest node above the locus skips the
+           part already matched */
+        template <typename F>
+        void matchSuffixes(std::string_view query, F f) const
+        {
+            Locus locus;
+            size_t length = 0;
+
+            if (_nodes.empty())
+            {
+                return;
+            }
+
+            for (size_t n = 0; n < query.size(); ++n)
+            {
+                while (n + length < query.size())
+                {
+                    char c = query[n + length];
+
+                    if (locus.offset == _nodes[locus.node].length)
+                    {
+                        auto child = findChild(locus.node, c);
+
+                        if (child == npos)
+                        {
+                            break;
+                        }
+
+                        locus = {static_cast<std::uint32_t>(child), 1};
+                    }
+                    else if (_labels[_nodes[locus.node].label + locus.offset] == c)
+                    {
+                        ++locus.offset;
+                    }
+                    else
+                    {
+                        break;
+                    }
+
+                    ++length;
+                }
+
+                f(n, static_cast<const Locus&>(locus), length);
+
+                if (length == 0)
+                {
+                    continue;
+                }
+
+                auto node = locus.node;
+
+                if (locus.offset < _nodes[node].length)
+                {
+                    node = _parents[node];
+                }
+
+                locus = (node == 0) ?
+                    skip(Locus{}, query.substr(n + 1, length - 1)) :
+                    skip(_links[node], query.substr(n + _depths[node], length - _depths[node]));
+                --length;
+            }
+        }
+
+        [[nodiscard]]
+        bool leftMaximal(std::string_view query, size_t position, size_t occurrence) const noexcept
+        {
+            auto offset = _occurrenceOffsets[occurrence];
+
+            return position == 0
+                || offset == 0
+                || query[position - 1]
+                   != _documentText[_documentOffsets[_occurrenceDocuments[occurrence]] + offset - 1];
+        }
+
+        [[nodiscard]]
+        ExactMatch exactMatch(size_t position, size_t occurrence, size_t length) const noexcept
+        {
+            return {position, document(_occurrenceDocuments[occurrence]),
+                    _occurrenceOffsets[occurrence], length};
+        }
+
+        // occurrences [begin, end) matching the query from position, on length characters
+        template <typename Sink>
+        void reportMatches(std::string_view query, size_t position,
+                           size_t begin, size_t end, size_t length, Sink& sink) const
+        {
+            for (size_t n = begin; n < end; ++n)
+            {
+                if (leftMaximal(query, position, n))
+                {
+                    sink(static_cast<const ExactMatch&>(exactMatch(position, n, length)));
+                }
+            }
+        }
+
+        template <typename Iterator>
+        void buildDocuments(Iterator first, Iterator last)
+        {
+            if (_nodes.empty())
+            {
+                return;
+            }
+
+            std::vector<std::uint32_t> parents(_nodes.size(), 0);
+            std::vector<std::uint32_t> depths(_nodes.size(), 0);
+            std::vector<std::uint32_t> subtreeSizes(_nodes.size(), 1);
+
+            // children come after their parent in breadth first order
+            for (size_t n = 0; n < _nodes.size(); ++n)
+            {
+                for (size_t m = 0; m < _nodes[n].childCount; ++m)
+                {
+                    parents[_nodes[n].firstChild + m] = static_cast<std::uint32_t>(n);
+                    depths[_nodes[n].firstChild + m] = depths[n] + 1;
+                }
+            }
+
+            for (size_t n = _nodes.size() - 1; n > 0; --n)
+            {
+                subtreeSizes[parents[n]] += subtreeSizes[n];
+            }
+
+            // pre-order numbers, the children of a node are kept in their order
+            std::vector<std::uint32_t> preorder(_nodes.size(), 0);
+            std::vector<std::uint32_t> preorderDepths(_nodes.size(), 0);
+
+            for (size_t n = 0; n < _nodes.size(); ++n)
+            {
+                auto next = preorder[n] + 1;
+
+                for (size_t m = 0; m < _nodes[n].childCount; ++m)
+                {
+                    auto child = _nodes[n].firstChild + m;
+
+                    preorder[child] = next;
+                    next += subtreeSizes[child];
+                }
+
+                preorderDepths[preorder[n]] = depths[n];
+            }
+
+            // node of each suffix of each word, and its position
+            std::vector<std::tuple<std::uint32_t, std::uint32_t, std::uint32_t>> occurrences;
+
+            _documentOffsets.push_back(0);
+
+            for (; first != last; ++first)
+            {
+                std::string_view word = *first;
+                auto id = static_cast<std::uint32_t>(_documentOffsets.size() - 1);
+
+                if (_documentText.size() + word.size()
+                    > std::numeric_limits<std::uint32_t>::max())
+                {
+                    throw std::length_error("too many documents to be indexed");
+                }
+
+                _documentText.append(word);
+                _documentOffsets.push_back(static_cast<std::uint32_t>(_documentText.size()));
+
+                size_t node = npos;
+
+                for (size_t n = 0; n < word.size(); ++n)
+                {
+                    // the suffix link of the node of a suffix leads to the next one
+                    node = (n > 0) ?
+                        linkedNode(node) :
+                        locate<normalization::Identity::Reader>(word);
+
+                    assertm(node != npos, "each suffix must have a node");
+                    occurrences.emplace_back(preorder[node], id, static_cast<std::uint32_t>(n));
+                }
+            }
+
+            std::sort(occurrences.begin(), occurrences.end());
+
+            RangeMinimumDepths lca{detail::RangeMinimum(std::move(preorderDepths)), {}};
+            std::vector<std::uint32_t> nodesByPreorder(_nodes.size());
+            std::vector<std::uint32_t> lastOccurrences(_documentOffsets.size() - 1, 0);
+            std::vector<std::int64_t> counts(_nodes.size(), 0);
+            std::vector<std::uint32_t> previous(occurrences.size());
+
+            for (size_t n = 0; n < _nodes.size(); ++n)
+            {
+                nodesByPreorder[preorder[n]] = static_cast<std::uint32_t>(n);
+            }
+
+            lca.parents = std::move(parents);
+            _occurrenceDocuments.resize(occurrences.size());
+
+            if (_matchesIndexed)
+            {
+                _occurrenceOffsets.resize(occurrences.size());
+            }
+
+            for (size_t n = 0; n < occurrences.size(); ++n)
+            {
+                auto [position, id, offset] = occurrences[n];
+
+                ++counts[nodesByPreorder[position]];
+
+                // previous occurrence of the same word is counted once at their LCA
+                if (lastOccurrences[id])
+                {
+                    auto previousPosition = std::get<0>(occurrences[lastOccurrences[id] - 1]);
+
+                    --counts[lca.lca(previousPosition, position, nodesByPreorder)];
+                }
+
+                previous[n] = lastOccurrences[id];
+                lastOccurrences[id] = static_cast<std::uint32_t>(n + 1);
+                _occurrenceDocuments[n] = id;
+
+                if (_matchesIndexed)
+                {
+                    _occurrenceOffsets[n] = offset;
+                }
+            }
+
+            for (size_t n = _nodes.size() - 1; n > 0; --n)
+            {
+                counts[lca.parents[n]] += counts[n];
+            }
+
+            _documentCounts.assign(counts.cbegin(), counts.cend());
+            _occurrenceRanges.resize(_nodes.size());
+
+            for (size_t n = 0; n < _nodes.size(); ++n)
+            {
+                auto begin = std::lower_bound(
+                    occurrences.cbegin(), occurrences.cend(),
+                    std::make_tuple(preorder[n], std::uint32_t(0), std::uint32_t(0)));
+                auto end = std::lower_bound(
+                    begin, occurrences.cend(),
+                    std::make_tuple(preorder[n] + subtreeSizes[n], std::uint32_t(0),
+                                    std::uint32_t(0)));
+
+                _occurrenceRanges[n] = {
+                    static_cast<std::uint32_t>(begin - occurrences.cbegin()),
+                    static_cast<std::uint32_t>(end - occurrences.cbegin())};
+            }
+
+            _previousOccurrences = detail::RangeMinimum(std::move(previous));
+        }
+
+        /* lowest common ancestor of the nodes at two distinct pre-order
+           positions : the parent of the shallowest node after the first one
+           up to the second one */
+        struct RangeMinimumDepths
+        {
+            detail::RangeMinimum depths;
+            std::vector<std::uint32_t> parents;
+
+            [[nodiscard]]
+            std::uint32_t lca(std::uint32_t lhs, std::uint32_t rhs,
+                              const std::vector<std::uint32_t>& nodesByPreorder) const
+            {
+                return parents[nodesByPreorder[depths.argmin(lhs + 1, rhs + 1)]];
+            }
+        };
+
+        template <typename SourceNode>
+        void build(const SourceNode* root)
+        {
+            if (!root)
+            {
+                return;
+            }
+
+            // _nodes[n] is the copy of queue[n]
+            std::vector<const SourceNode*> queue = {root};
+            std::vector<const SourceNode*> children;
+
+            _nodes.emplace_back();
+            _firstChars.push_back('\0');
+
+            for (size_t n = 0; n < queue.size(); ++n)
+            {
+                const auto& source = *queue[n];
+
+                children.clear();
+
+                for (const auto& [_, childNode] : source.childNodes)
+                {
+                    children.push_back(childNode.get());
+                }
+
+                std::sort(children.begin(), children.end(),
+                          [](const SourceNode* lhs, const SourceNode* rhs)
+                          {
+                              return static_cast<unsigned char>(lhs->s[0])
+                                  < static_cast<unsigned char>(rhs->s[0]);
+                          });
+
+                if (_labels.size() + source.s.size()
+                    > std::numeric_limits<std::uint32_t>::max())
+                {
+                    throw std::length_error("tree too large to be frozen");
+                }
+
+                _nodes[n].label = static_cast<std::uint32_t>(_labels.size());
+                _nodes[n].length = static_cast<std::uint32_t>(source.s.size());
+                _nodes[n].firstChild = static_cast<std::uint32_t>(queue.size());
+                _nodes[n].childCount = static_cast<std::uint32_t>(children.size());
+                _nodes[n].terminalCount = source.terminalCount;
+                _nodes[n].terminalWord = source.terminalWord;
+                _labels.append(source.s.data(), source.s.size());
+
+                for (auto childNode : children)
+                {
+                    queue.push_back(childNode);
+                    _nodes.emplace_back();
+                    _firstChars.push_back(childNode->s[0]);
+                }
+            }
+
+            _nodes.shrink_to_fit();
+            _firstChars.shrink_to_fit();
+            _labels.shrink_to_fit();
+        }
+
+        [[nodiscard]]
+        size_t findChild(size_t node, char c) const noexcept
+        {
+            auto begin = _firstChars.cbegin() + _nodes[node].firstChild;
+            auto end = begin + _nodes[node].childCount;
+            auto it = std::find(begin, end, c);
+
+            return (it == end) ? npos : it - _firstChars.cbegin();
+        }
+
+        // node whose path is the normalized query, npos otherwise
+        template <typename Reader = typename Normalizer::Reader>
+        [[nodiscard]]
+        size_t locate(std::string_view query) const
+        {
+            return query.empty() ? npos : find<Reader>(query, false);
+        }
+
+        /* highest node whose path starts with the normalized query, the root
+           for an empty one, npos if the query is not a substring */
+        [[nodiscard]]
+        size_t locus(std::string_view query) const
+        {
+            return find<typename Normalizer::Reader>(query, true);
+        }
+
+        /* node of the query, or the node whose label it ends in if partial,
+           starting from the jump table when the query is long enough */
+        template <typename Reader>
+        [[nodiscard]]
+        size_t find(std::string_view query, bool partial) const
+        {
+            if (_nodes.empty())
+            {
+                return npos;
+            }
+
+            if (_jumpLength > 0)
+            {
+                Reader reader(query);
+                size_t key = 0;
+                size_t n = 0;
+
+                for (; n < _jumpLength && !reader.empty(); ++n)
+                {
+                    key = (key << 8) | static_cast<unsigned char>(reader.get());
+                }
+
+                if (n == _jumpLength)
+                {
+                    auto [node, offset] = _jumpTable[key];
+
+                    return (node == noJump) ? npos : descend(reader, node, offset, partial);
+                }
+            }
+
+            Reader reader(query);
+
+            return descend(reader, 0, 0, partial);
+        }
+
+        // goes on reading from the offset-th character of the label of node
+        template <typename Reader>
+        [[nodiscard]]
+        size_t descend(Reader& reader, size_t node, size_t offset, bool partial) const
+        {
+            for (;;)
+            {
+                const char* label = _labels.data() + _nodes[node].label;
+
+                for (size_t n = offset; n < _nodes[node].length; ++n)
+                {
+                    if (reader.empty())
+                    {
+                        return partial ? node : npos;
+                    }
+
+                    if (reader.get() != label[n])
+                    {
+                        return npos;
+                    }
+                }
+
+                if (reader.empty())
+                {
+                    return node;
+                }
+
+                node = findChild(node, reader.get());
+
+                if (node == npos)
+                {
+                    return npos;
+                }
+
+                offset = 1;
+            }
+        }
+
+        // locus after each string of _jumpLength characters
+        void buildJumpTable()
+        {
+            _jumpTable.assign(size_t(1) << (8 * _jumpLength), {noJump, 0});
+
+            // (node, depth of its parent, key of the path up to the parent)
+            std::vector<std::tuple<size_t, size_t, size_t>> stack;
+
+            for (size_t n = 0; n < _nodes[0].childCount; ++n)
+            {
+                stack.emplace_back(_nodes[0].firstChild + n, 0, 0);
+            }
+
+            while (!stack.empty())
+            {
+                auto [node, depth, key] = stack.back();
+                const char* label = _labels.data() + _nodes[node].label;
+                size_t length = std::min<size_t>(_nodes[node].length, _jumpLength - depth);
+
+                stack.pop_back();
+
+                for (size_t n = 0; n < length; ++n)
+                {
+                    key = (key << 8) | static_cast<unsigned char>(label[n]);
+                }
+
+                if (depth + length == _jumpLength)
+                {
+                    _jumpTable[key] = {static_cast<std::uint32_t>(node),
+                                       static_cast<std::uint32_t>(length)};
+
+                    continue;
+                }
+
+                for (size_t n = 0; n < _nodes[node].childCount; ++n)
+                {
+                    stack.emplace_back(_nodes[node].firstChild + n, depth + length, key);
+                }
+            }
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,238 @@
+#ifndef INSTRUMENTATION_HPP_
+# define INSTRUMENTATION_HPP_
+
+# include <array>
+# include <algorithm>
+# include <atomic>
+# include <chrono>
+# include <cstddef>
+
+namespace container
+{
+    /* instrumentation policies of the trees. A policy provides :
+         static constexpr bool enabled;
+         void onOperation(Operation, const OperationStats&,
+                          std::chrono::nanoseconds) const;
+       "onOperation" is called at the end of each public operation with the
+       work it did, when "enabled" is false nothing is counted nor timed */
+    namespace instrumentation
+    {
+        enum class Operation : unsigned char
+        {
+            Search,
+            EndsWith,
+            Find, // "find" and "frequency"
+            Insert,
+            Erase,
+            Merge,
+            Seek, // "lower_bound", "upper_bound" and "range"
+            Load,
+            Pattern // "searchPattern" and "substringsMatching"
+        };
+
+        inline constexpr size_t operationCount = 9;
+
+        struct OperationStats
+        {
+            size_t nodesVisited = 0;
+            size_t childEntriesScanned = 0;
+            size_t labelBytesCompared = 0;
+            size_t nodesSplit = 0;
+            size_t nodesMerged = 0;
+            size_t allocations = 0;
+        };
+
+        struct None
+        {
+            static constexpr bool enabled = false;
+
+            void onOperation(Operation,
+                             const OperationStats&,
+                             std::chrono::nanoseconds) const noexcept
+            { }
+        };
+
+        /* sums the stats of each operation kind and keeps a latency histogram,
+           bucket n counting durations within [2^n, 2^(n+1)) nanoseconds. Safe
+           to share between threads running queries concurrently */
+        class Counting
+        {
+        public :
+            static constexpr bool enabled = true;
+            static constexpr size_t latencyBucketCount = 40;
+
+            void onOperation(Operation operation,
+                             const OperationStats& stats,
+                             std::chrono::nanoseconds duration) const noexcept
+            {
+                auto& counters = _counters[static_cast<size_t>(operation)];
+
+                add(counters.count, 1);
+                add(counters.nodesVisited, stats.nodesVisited);
+                add(counters.childEntriesScanned, stats.childEntriesScanned);
+                add(counters.labelBytesCompared, stats.labelBytesCompared);
+                add(counters.nodesSplit, stats.nodesSplit);
+                add(counters.nodesMerged, stats.nodesMerged);
+                add(counters.allocations, stats.allocations);
+                add(counters.latencies[latencyBucket(duration)], 1);
+            }
+
+            [[nodiscard]]
+            size_t count(Operation operation) const noexcept
+            {
+                return load(_counters[static_cast<size_t>(operation)].count);
+            }
+
+            [[nodiscard]]
+            OperationStats totals(Operation operation) const noexcept
+            {
+                const auto& counters = _counters[static_cast<size_t>(operation)];
+
+                return {load(counters.nodesVisited),
+                        load(counters.childEntriesScanned),
+                        load(counters.labelBytesCompared),
+                        load(counters.nodesSplit),
+                        load(counters.nodesMerged),
+                        load(counters.allocations)};
+            }
+
+            [[nodiscard]]
+            std::array<size_t, latencyBucketCount> latencies(
+                Operation operation) const noexcept
+            {
+                const auto& counters = _counters[static_cast<size_t>(operation)];
+                std::array<size_t, latencyBucketCount> res = {};
+
+                for (size_t n = 0; n < latencyBucketCount; ++n)
+                {
+                    res[n] = load(counters.latencies[n]);
+                }
+
+                return res;
+            }
+
+            void reset() noexcept
+            {
+                for (auto& counters : _counters)
+                {
+                    counters.count = 0;
+                    counters.nodesVisited = 0;
+                    counters.childEntriesScanned = 0;
+                    counters.labelBytesCompared = 0;
+                    counters.nodesSplit = 0;
+                    counters.nodesMerged = 0;
+                    counters.allocations = 0;
+
+                    for (auto& latency : counters.latencies)
+                    {
+                        latency = 0;
+                    }
+                }
+            }
+
+        private :
+            struct Counters
+            {
+                std::atomic<size_t> count = 0;
+                std::atomic<size_t> nodesVisited = 0;
+                std::atomic<size_t> childEntriesScanned = 0;
+                std::atomic<size_t> labelBytesCompared = 0;
+                std::atomic<size_t> nodesSplit = 0;
+                std::atomic<size_t> nodesMerged = 0;
+                std::atomic<size_t> allocations = 0;
+                std::atomic<size_t> latencies[latencyBucketCount] = {};
+            };
+
+            mutable std::array<Counters, operationCount> _counters;
+
+            static void add(std::atomic<size_t>& counter, size_t n) noexcept
+            {
+                if (n)
+                {
+                    counter.fetch_add(n, std::memory_order_relaxed);
+                }
+            }
+
+            [[nodiscard]]
+            static size_t load(const std::atomic<size_t>& counter) noexcept
+            {
+                return counter.load(std::memory_order_relaxed);
+            }
+
+            [[nodiscard]]
+            static size_t latencyBucket(std::chrono::nanoseconds duration) noexcept
+            {
+                size_t bucket = 0;
+
+                for (auto n = duration.count(); n > 1; n >>= 1)
+                {
+                    ++bucket;
+                }
+
+                return std::min(bucket, latencyBucketCount - 1);
+            }
+        };
+
+        namespace detail
+        {
+            // stats of the operation running on the current thread
+            struct CurrentOperation
+            {
+                static inline thread_local OperationStats stats;
+                static inline thread_local unsigned depth = 0;
+            };
+        }
+
+        [[nodiscard]]
+        inline OperationStats& currentStats() noexcept
+        {
+            return detail::CurrentOperation::stats;
+        }
+
+        /* measures an operation from its construction to its destruction,
+           operations nested in another one are counted as part of it */
+        template <typename Policy>
+        class Scope
+        {
+        public :
+            Scope(const Policy& policy, Operation operation) noexcept :
+                _policy(policy),
+                _operation(operation)
+            {
+                if constexpr (Policy::enabled)
+                {
+                    if (detail::CurrentOperation::depth++ == 0)
+                    {
+                        currentStats() = {};
+                        _start = std::chrono::steady_clock::now();
+                    }
+                }
+            }
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+            ~Scope()
+            {
+                if constexpr (Policy::enabled)
+                {
+                    if (--detail::CurrentOperation::depth == 0)
+                    {
+                        _policy.onOperation(
+                            _operation,
+                            currentStats(),
+                            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::steady_clock::now() - _start));
+                    }
+                }
+            }
+
+        private :
+            const Policy& _policy;
+            Operation _operation;
+            std::chrono::steady_clock::time_point _start;
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,331 @@
+#ifndef LAZY_SUFFIX_TREE_HPP_
+# define LAZY_SUFFIX_TREE_HPP_
+
+# include <vector>
+# include <array>
+# include <initializer_list>
+# include <string>
+# include <string_view>
+# include <algorithm>
+# include <limits>
+# include <stdexcept>
+# include <utility>
+# include <cstdint>
+# include <cstddef>
+
+namespace container
+{
+    /* suffix tree of words built top down on demand (write-only top-down,
+       WOTD) : insertion only stores the words, a node is expanded the first
+       time a query descends into it by partitioning the suffixes reaching it
+       on their next character. An unexpanded subtree is a range of the
+       array of suffixes, the only structure allocated for all of them.
+
+       Queries expand the tree, they are neither const nor thread-safe.
+       Inserting a word discards the expanded nodes */
+    class LazySuffixTree
+    {
+    public :
+        LazySuffixTree() = default;
+
+        LazySuffixTree(std::initializer_list<std::string_view> words)
+        {
+            for (auto word : words)
+            {
+                insert(word);
+            }
+        }
+
+        /* false for an empty word, inserting a word again doesn't change the
+           answers of the queries */
+        bool insert(std::string_view word)
+        {
+            if (word.empty())
+            {
+                return false;
+            }
+
+            if (_text.size() + word.size() > std::numeric_limits<std::uint32_t>::max())
+            {
+                throw std::length_error("too many characters to be indexed");
+            }
+
+            _wordStarts.resize(_text.size() + word.size(), false);
+            _wordStarts[_text.size()] = true;
+            _wordEnds.push_back(static_cast<std::uint32_t>(_text.size() + word.size()));
+            _text.append(word);
+            _nodes.clear();
+            _suffixes.clear();
+
+            return true;
+        }
+
+        [[nodiscard]]
+        inline bool empty() const noexcept { return _text.empty(); }
+
+        // number of insertions
+        [[nodiscard]]
+        inline size_t wordCount() const noexcept { return _wordEnds.size(); }
+
+        // nodes materialized by the queries so far, root included
+        [[nodiscard]]
+        inline size_t expandedNodeCount() const noexcept { return _nodes.size(); }
+
+        [[nodiscard]]
+        size_t memoryUsage() const noexcept
+        {
+            return _text.capacity()
+                + _wordStarts.capacity() / 8
+                + _wordEnds.capacity() * sizeof(std::uint32_t)
+                + (_suffixes.capacity() + _buffer.capacity()) * sizeof(Suffix)
+                + _nodes.capacity() * sizeof(Node);
+        }
+
+        void clear() noexcept
+        {
+            _text.clear();
+            _wordStarts.clear();
+            _wordEnds.clear();
+            _suffixes.clear();
+            _buffer.clear();
+            _nodes.clear();
+        }
+
+        [[nodiscard]]
+        bool search(std::string_view word)
+        {
+            auto [node, atNode] = locate(word);
+
+            return node != npos && atNode && _nodes[node].terminalWord;
+        }
+
+        // true if the suffix is a proper suffix of a stored word
+        [[nodiscard]]
+        bool endsWith(std::string_view suffix)
+        {
+            auto [node, atNode] = locate(suffix);
+
+            return node != npos && atNode && _nodes[node].properSuffix;
+        }
+
+        // true if the substring is part of a stored word
+        [[nodiscard]]
+        bool contains(std::string_view substring)
+        {
+            return !substring.empty() && locate(substring).first != npos;
+        }
+
+    private :
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+        struct Suffix
+        {
+            std::uint32_t begin;
+            std::uint32_t end; // end of its word
+        };
+
+        struct Node
+        {
+            std::uint32_t label = 0; // offset of the label in _text
+            std::uint32_t length = 0;
+            std::uint32_t depth = 0; // length of the path from the root
+            std::uint32_t first = 0; // range of the suffixes reaching the node
+            std::uint32_t last = 0;
+            std::uint32_t firstChild = 0;
+            std::uint32_t childCount = 0;
+            bool expanded = false;
+            bool terminalWord = false; // a word ends here
+            bool properSuffix = false; // a suffix which isn't a word ends here
+        };
+
+        std::string _text; // words, concatenated
+        std::vector<bool> _wordStarts;
+        std::vector<std::uint32_t> _wordEnds;
+        std::vector<Suffix> _suffixes; // permuted by the expansions
+        std::vector<Suffix> _buffer; // used by the counting sort of the expansions
+        std::vector<Node> _nodes; // the root first, children adjacent
+
+        [[nodiscard]]
+        inline unsigned char charAt(const Suffix& suffix, size_t depth) const noexcept
+        {
+            return static_cast<unsigned char>(_text[suffix.begin + depth]);
+        }
+
+        // the root covers all suffixes
+        void makeRoot()
+        {
+            _suffixes.reserve(_text.size());
+
+            for (std::uint32_t begin = 0, word = 0; begin < _text.size(); ++begin)
+            {
+                if (begin == _wordEnds[word])
+                {
+                    ++word;
+                }
+
+                _suffixes.push_back({begin, _wordEnds[word]});
+            }
+
+            _nodes.emplace_back();
+            _nodes[0].last = static_cast<std::uint32_t>(_suffixes.size());
+        }
+
+        // partitions the suffixes of a node among new children
+        void expand(size_t n)
+        {
+            auto depth = _nodes[n].depth;
+            auto first = _suffixes.begin() + _nodes[n].first;
+            auto last = _suffixes.begin() + _nodes[n].last;
+
+            // suffixes ending at the node don't go further
+            first = std::partition(first, last, [depth](const Suffix& suffix)
+            {
+                return suffix.end - suffix.begin == depth;
+            });
+
+            // counting sort on the next character
+            std::array<size_t, 257> offsets = {};
+
+            for (auto it = first; it != last; ++it)
+            {
+                ++offsets[charAt(*it, depth) + 1];
+            }
+
+            for (size_t c = 1; c < offsets.size(); ++c)
+            {
+                offsets[c] += offsets[c - 1];
+            }
+
+            _buffer.resize(last - first);
+
+            for (auto it = first; it != last; ++it)
+            {
+                _buffer[offsets[charAt(*it, depth)]++] = *it;
+            }
+
+            std::copy(_buffer.cbegin(), _buffer.cend(), first);
+
+            auto firstChild = static_cast<std::uint32_t>(_nodes.size());
+
+            for (auto group = first; group != last;)
+            {
+                auto c = charAt(*group, depth);
+                auto groupEnd = std::find_if(group, last, [&](const Suffix& suffix)
+                {
+                    return charAt(suffix, depth) != c;
+                });
+
+                _nodes.push_back(makeChild(group, groupEnd, depth));
+                group = groupEnd;
+            }
+
+            _nodes[n].firstChild = firstChild;
+            _nodes[n].childCount = static_cast<std::uint32_t>(_nodes.size() - firstChild);
+            _nodes[n].expanded = true;
+        }
+
+        // child for suffixes sharing their character at depth
+        Node makeChild(std::vector<Suffix>::iterator first,
+                       std::vector<Suffix>::iterator last,
+                       std::uint32_t depth) const
+        {
+            std::uint32_t length = 1;
+
+            // the label goes up to the longest common prefix of the suffixes
+            while (std::all_of(first, last, [&](const Suffix& suffix)
+                   {
+                       return suffix.end - suffix.begin > depth + length
+                           && charAt(suffix, depth + length) == charAt(*first, depth + length);
+                   }))
+            {
+                ++length;
+            }
+
+            Node child;
+
+            child.label = first->begin + depth;
+            child.length = length;
+            child.depth = depth + length;
+            child.first = static_cast<std::uint32_t>(first - _suffixes.begin());
+            child.last = static_cast<std::uint32_t>(last - _suffixes.begin());
+
+            for (auto it = first; it != last; ++it)
+            {
+                if (it->end - it->begin == child.depth)
+                {
+                    (_wordStarts[it->begin] ? child.terminalWord : child.properSuffix) = true;
+                }
+            }
+
+            return child;
+        }
+
+        [[nodiscard]]
+        size_t findChild(size_t n, char c)
+        {
+            if (!_nodes[n].expanded)
+            {
+                expand(n);
+            }
+
+            for (size_t child = _nodes[n].firstChild;
+                 child < _nodes[n].firstChild + _nodes[n].childCount; ++child)
+            {
+                if (_text[_nodes[child].label] == c)
+                {
+                    return child;
+                }
+            }
+
+            return npos;
+        }
+
+        /* node reached by the query, npos if the query isn't a substring, and
+           whether the query ends on that node or within its label */
+        [[nodiscard]]
+        std::pair<size_t, bool> locate(std::string_view query)
+        {
+            if (_text.empty() || query.empty())
+            {
+                return {npos, false};
+            }
+
+            if (_nodes.empty())
+            {
+                makeRoot();
+            }
+
+            size_t node = 0;
+
+            while (!query.empty())
+            {
+                node = findChild(node, query[0]);
+
+                if (node == npos)
+                {
+                    return {npos, false};
+                }
+
+                auto label = std::string_view(_text).substr(
+                    _nodes[node].label, _nodes[node].length);
+                auto length = std::min(label.size(), query.size());
+
+                if (label.compare(0, length, query, 0, length) != 0)
+                {
+                    return {npos, false};
+                }
+
+                if (length < label.size())
+                {
+                    return {node, false};
+                }
+
+                query.remove_prefix(length);
+            }
+
+            return {node, true};
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,222 @@
+#ifndef LEMPEL_ZIV_HPP_
+# define LEMPEL_ZIV_HPP_
+
+# include <string>
+# include <string_view>
+# include <utility>
+# include <cstdint>
+# include <cstddef>
+
+# include "SuffixAutomaton.hpp"
+
+namespace container
+{
+    /* copy of "length" bytes followed by a literal byte. The copy starts
+       "offset" bytes before the current end of the output for LZ77, at
+       "offset" in the reference for relative Lempel-Ziv */
+    struct LzToken
+    {
+        std::uint64_t offset = 0;
+        std::uint64_t length = 0;
+        char literal = '\0';
+
+        [[nodiscard]]
+        friend inline bool operator==(const LzToken& lhs, const LzToken& rhs) noexcept
+        {
+            return lhs.offset == rhs.offset
+                && lhs.length == rhs.length
+                && lhs.literal == rhs.literal;
+        }
+
+        [[nodiscard]]
+        friend inline bool operator!=(const LzToken& lhs, const LzToken& rhs) noexcept
+        {
+            return !(lhs == rhs);
+        }
+    };
+
+    /* LZ77 factorization in linear time : each token copies the longest
+       previous factor of its position (the source may overlap it) and adds
+       the next byte, the copy being shortened by one byte at the end of the
+       text. The suffix automaton of the text is extended while the factors
+       are searched, so that it always holds the bytes before the last
+       character of the current factor. sink(const LzToken&) gets the tokens */
+    template <typename Sink>
+    void lz77(std::string_view text, Sink&& sink)
+    {
+        SuffixAutomaton automaton;
+        size_t built = 0;
+
+        for (size_t n = 0; n < text.size();)
+        {
+            auto state = SuffixAutomaton::root;
+            size_t length = 0;
+
+            while (n + length + 1 < text.size())
+            {
+                // an occurrence starting before n ends before n + length
+                for (; built < n + length; ++built)
+                {
+                    automaton.extend(text[built]);
+
+                    // the strings of state may have moved to a clone
+                    while (state != SuffixAutomaton::root
+                           && automaton.length(automaton.link(state)) >= length)
+                    {
+                        state = automaton.link(state);
+                    }
+                }
+
+                auto next = automaton.next(state, text[n + length]);
+
+                if (next == SuffixAutomaton::npos)
+                {
+                    break;
+                }
+
+                state = next;
+                ++length;
+            }
+
+            LzToken token;
+
+            if (length > 0)
+            {
+                token.offset = n - (automaton.firstEnd(state) + 1 - length);
+                token.length = length;
+            }
+
+            token.literal = text[n + length];
+            sink(static_cast<const LzToken&>(token));
+            n += length + 1;
+        }
+    }
+
+    // rebuilds the text of LZ77 tokens given one by one
+    class Lz77Decoder
+    {
+    public :
+        void operator()(const LzToken& token)
+        {
+            auto source = _text.size() - token.offset;
+
+            // byte by byte since the source may overlap the copy
+            for (std::uint64_t n = 0; n < token.length; ++n)
+            {
+                _text.push_back(_text[source + n]);
+            }
+
+            _text.push_back(token.literal);
+        }
+
+        [[nodiscard]]
+        inline const std::string& text() const noexcept { return _text; }
+
+        [[nodiscard]]
+        inline std::string release() noexcept { return std::move(_text); }
+
+    private :
+        std::string _text;
+    };
+
+    /* relative Lempel-Ziv : texts are encoded as copies of the longest
+       prefixes found in a reference, which can be made of the stored words
+       of a tree. The suffix automaton of the reference is built once, each
+       text is then encoded in linear time */
+    class RlzEncoder
+    {
+    public :
+        explicit RlzEncoder(std::string reference) :
+            _reference(std::move(reference)),
+            _automaton(_reference)
+        { }
+
+        // the reference is the concatenation of the words, e.g. of a tree
+        template <typename InputIterator>
+        RlzEncoder(InputIterator first, InputIterator last) :
+            RlzEncoder(concatenate(first, last))
+        { }
+
+        [[nodiscard]]
+        inline const std::string& reference() const noexcept { return _reference; }
+
+        template <typename Sink>
+        void encode(std::string_view text, Sink&& sink) const
+        {
+            for (size_t n = 0; n < text.size();)
+            {
+                auto state = SuffixAutomaton::root;
+                size_t length = 0;
+
+                while (n + length + 1 < text.size())
+                {
+                    auto next = _automaton.next(state, text[n + length]);
+
+                    if (next == SuffixAutomaton::npos)
+                    {
+                        break;
+                    }
+
+                    state = next;
+                    ++length;
+                }
+
+                LzToken token;
+
+                if (length > 0)
+                {
+                    token.offset = _automaton.firstEnd(state) + 1 - length;
+                    token.length = length;
+                }
+
+                token.literal = text[n + length];
+                sink(static_cast<const LzToken&>(token));
+                n += length + 1;
+            }
+        }
+
+    private :
+        std::string _reference;
+        SuffixAutomaton _automaton;
+
+        template <typename InputIterator>
+        static std::string concatenate(InputIterator first, InputIterator last)
+        {
+            std::string res;
+
+            for (; first != last; ++first)
+            {
+                res.append(*first);
+            }
+
+            return res;
+        }
+    };
+
+    // rebuilds the texts of relative Lempel-Ziv tokens given one by one
+    class RlzDecoder
+    {
+    public :
+        explicit RlzDecoder(std::string_view reference) noexcept :
+            _reference(reference)
+        { }
+
+        void operator()(const LzToken& token)
+        {
+            _text.append(_reference.substr(token.offset, token.length));
+            _text.push_back(token.literal);
+        }
+
+        [[nodiscard]]
+        inline const std::string& text() const noexcept { return _text; }
+
+        [[nodiscard]]
+        inline std::string release() noexcept { return std::move(_text); }
+
+    private :
+        std::string_view _reference; // must outlive the decoder
+        std::string _text;
+    };
+}
+
+#endif
@@ -0,0 +1,308 @@
+#ifndef NORMALIZATION_HPP_
+# define NORMALIZATION_HPP_
+
+# include <array>
+# include <string>
+# include <string_view>
+# include <cstddef>
+
+namespace container
+{
+    /* normalization policies of the trees, applied to words when they are
+       stored and to queries while descending the tree. A policy provides :
+         static constexpr bool identity; // true if nothing is normalized
+         class Reader                    // normalized bytes of a string
+         {
+             explicit Reader(std::string_view s);
+             bool empty() const;         // no more byte
+             char get();                 // next byte, reader must not be empty
+         }; */
+    namespace normalization
+    {
+        struct Identity
+        {
+            static constexpr bool identity = true;
+
+            class Reader
+            {
+            public :
+                explicit Reader(std::string_view s) noexcept :
+                    _rest(s)
+                { }
+
+                [[nodiscard]]
+                inline bool empty() const noexcept { return _rest.empty(); }
+
+                [[nodiscard]]
+                inline char get() noexcept
+                {
+                    char c = _rest.front();
+
+                    _rest.remove_prefix(1);
+
+                    return c;
+                }
+
+            private :
+                std::string_view _rest;
+            };
+        };
+
+        // ASCII letters are lowered through a table, other bytes are kept
+        struct AsciiCaseFold
+        {
+            static constexpr bool identity = false;
+
+            static constexpr std::array<char, 256> table = []
+            {
+                std::array<char, 256> res = {};
+
+                for (size_t n = 0; n < res.size(); ++n)
+                {
+                    res[n] = static_cast<char>(
+                        (n >= 'A' && n <= 'Z') ? n - 'A' + 'a' : n);
+                }
+
+                return res;
+            }();
+
+            class Reader
+            {
+            public :
+                explicit Reader(std::string_view s) noexcept :
+                    _rest(s)
+                { }
+
+                [[nodiscard]]
+                inline bool empty() const noexcept { return _rest.empty(); }
+
+                [[nodiscard]]
+                inline char get() noexcept
+                {
+                    char c = table[static_cast<unsigned char>(_rest.front())];
+
+                    _rest.remove_prefix(1);
+
+                    return c;
+                }
+
+            private :
+                std::string_view _rest;
+            };
+        };
+
+        namespace detail
+        {
+            /* simple case folding (one code point to one code point) of the
+               Latin, Greek and Cyrillic letters having one */
+            [[nodiscard]]
+            constexpr char32_t foldCase(char32_t c) noexcept
+            {
+                if ((c >= 'A' && c <= 'Z')
+                    || (c >= 0xC0 && c <= 0xDE && c != 0xD7)
+                    || (c >= 0x391 && c <= 0x3A9 && c != 0x3A2)
+                    || (c >= 0x410 && c <= 0x42F))
+                {
+                    return c + 0x20;
+                }
+
+                if (c >= 0x100 && c <= 0x17F)
+                {
+                    if (c == 0x130)
+                    {
+                        return 'i';
+                    }
+
+                    if (c == 0x178)
+                    {
+                        return 0xFF;
+                    }
+
+                    // upper case letters are followed by their lower case
+                    bool upper = (c <= 0x137 || (c >= 0x14A && c <= 0x177)) ?
+                        c % 2 == 0 :
+                        ((c >= 0x139 && c <= 0x148) || (c >= 0x179 && c <= 0x17E))
+                        && c % 2 == 1;
+
+                    return upper ? c + 1 : c;
+                }
+
+                if (c >= 0x400 && c <= 0x40F)
+                {
+                    return c + 0x50;
+                }
+
+                switch (c)
+                {
+                    case 0x386: return 0x3AC;
+                    case 0x388: case 0x389: case 0x38A: return c + 0x25;
+                    case 0x38C: return 0x3CC;
+                    case 0x38E: case 0x38F: return c + 0x3F;
+                    default: return c;
+                }
+            }
+
+            // base letters of U+00C0 to U+017F, '.' when there is none
+            inline constexpr std::string_view latinBaseLetters =
+                "aaaaaa.ceeeeiiii.nooooo.ouuuuy.."
+                "aaaaaa.ceeeeiiii.nooooo.ouuuuy.y"
+                "aaaaaaccccccccddddeeeeeeeeeegggg"
+                "gggghhhhiiiiiiiiii..jjkk.lllllll"
+                "lllnnnnnn...oooooo..rrrrrrssssss"
+                "ssttttttuuuuuuuuuuuuwwyyyzzzzzzs";
+
+            [[nodiscard]]
+            constexpr char32_t foldAccents(char32_t c) noexcept
+            {
+                c = foldCase(c);
+
+                if (c >= 0xC0 && c <= 0x17F && latinBaseLetters[c - 0xC0] != '.')
+                {
+                    return static_cast<char32_t>(latinBaseLetters[c - 0xC0]);
+                }
+
+                return c;
+            }
+
+            /* decodes UTF-8 code points, folds them and encodes them again.
+               Invalid sequences are kept byte by byte */
+            template <char32_t (*Fold)(char32_t) noexcept>
+            class Utf8Reader
+            {
+            public :
+                explicit Utf8Reader(std::string_view s) noexcept :
+                    _rest(s)
+                { }
+
+                [[nodiscard]]
+                inline bool empty() const noexcept
+                {
+                    return _pos == _size && _rest.empty();
+                }
+
+                [[nodiscard]]
+                char get() noexcept
+                {
+                    if (_pos == _size)
+                    {
+                        refill();
+                    }
+
+                    return _pending[_pos++];
+                }
+
+            private :
+                std::string_view _rest;
+                char _pending[4] = {};
+                unsigned char _size = 0;
+                unsigned char _pos = 0;
+
+                void refill() noexcept
+                {
+                    auto lead = static_cast<unsigned char>(_rest[0]);
+                    size_t length = (lead < 0x80) ? 1 :
+                                    ((lead >> 5) == 0x6) ? 2 :
+                                    ((lead >> 4) == 0xE) ? 3 :
+                                    ((lead >> 3) == 0x1E) ? 4 : 0;
+                    char32_t c = (length == 1) ? lead :
+                                 (length == 2) ? lead & 0x1F :
+                                 (length == 3) ? lead & 0x0F : lead & 0x07;
+
+                    for (size_t n = 1; n < length; ++n)
+                    {
+                        auto byte = (n < _rest.size()) ?
+                            static_cast<unsigned char>(_rest[n]) : 0;
+
+                        if ((byte >> 6) != 0x2)
+                        {
+                            length = 0;
+
+                            break;
+                        }
+
+                        c = (c << 6) | (byte & 0x3F);
+                    }
+
+                    _pos = 0;
+
+                    if (length == 0)
+                    {
+                        _pending[0] = _rest[0];
+                        _size = 1;
+                        _rest.remove_prefix(1);
+
+                        return;
+                    }
+
+                    _rest.remove_prefix(length);
+                    encode(Fold(c));
+                }
+
+                void encode(char32_t c) noexcept
+                {
+                    if (c < 0x80)
+                    {
+                        _pending[0] = static_cast<char>(c);
+                        _size = 1;
+                    }
+                    else if (c < 0x800)
+                    {
+                        _pending[0] = static_cast<char>(0xC0 | (c >> 6));
+                        _pending[1] = static_cast<char>(0x80 | (c & 0x3F));
+                        _size = 2;
+                    }
+                    else if (c < 0x10000)
+                    {
+                        _pending[0] = static_cast<char>(0xE0 | (c >> 12));
+                        _pending[1] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+                        _pending[2] = static_cast<char>(0x80 | (c & 0x3F));
+                        _size = 3;
+                    }
+                    else
+                    {
+                        _pending[0] = static_cast<char>(0xF0 | (c >> 18));
+                        _pending[1] = static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+                        _pending[2] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+                        _pending[3] = static_cast<char>(0x80 | (c & 0x3F));
+                        _size = 4;
+                    }
+                }
+            };
+        }
+
+        // simple case folding of UTF-8 Latin, Greek and Cyrillic letters
+        struct Utf8CaseFold
+        {
+            static constexpr bool identity = false;
+
+            using Reader = detail::Utf8Reader<detail::foldCase>;
+        };
+
+        // as Utf8CaseFold, Latin letters losing their diacritics as well
+        struct Utf8AccentFold
+        {
+            static constexpr bool identity = false;
+
+            using Reader = detail::Utf8Reader<detail::foldAccents>;
+        };
+
+        template <typename Policy>
+        [[nodiscard]]
+        std::string normalize(std::string_view s)
+        {
+            std::string res;
+            typename Policy::Reader reader(s);
+
+            res.reserve(s.size());
+
+            while (!reader.empty())
+            {
+                res.push_back(reader.get());
+            }
+
+            return res;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,236 @@
+#ifndef NUMA_REPLICATED_SUFFIX_TREE_HPP_
+# define NUMA_REPLICATED_SUFFIX_TREE_HPP_
+
+# include <vector>
+# include <string>
+# include <string_view>
+# include <memory>
+# include <thread>
+# include <fstream>
+# include <filesystem>
+# include <algorithm>
+
+# include <pthread.h>
+# include <sched.h>
+
+# include "FrozenSuffixTree.hpp"
+
+namespace container
+{
+    // NUMA nodes and their CPUs as described by sysfs
+    class NumaTopology
+    {
+    public :
+        /* a machine without sysfs NUMA description is considered as a single
+           node owning all CPUs */
+        [[nodiscard]]
+        static NumaTopology detect(
+            const std::filesystem::path& root = "/sys/devices/system/node")
+        {
+            NumaTopology topology;
+            std::error_code ec;
+
+            for (const auto& entry : std::filesystem::directory_iterator(root, ec))
+            {
+                auto name = entry.path().filename().string();
+
+                if (name.size() <= 4 || name.compare(0, 4, "node") != 0
+                    || !std::all_of(name.cbegin() + 4, name.cend(),
+                                    [](char c) { return c >= '0' && c <= '9'; }))
+                {
+                    continue;
+                }
+
+                std::ifstream ifs(entry.path() / "cpulist");
+                std::string cpuList;
+
+                if (std::getline(ifs, cpuList))
+                {
+                    topology._nodes.push_back({std::stoul(name.substr(4)),
+                                               parseCpuList(cpuList)});
+                }
+            }
+
+            if (topology._nodes.empty())
+            {
+                topology._nodes.push_back({0, {}});
+            }
+
+            std::sort(topology._nodes.begin(), topology._nodes.end(),
+                      [](const auto& lhs, const auto& rhs) { return lhs.id < rhs.id; });
+
+            for (size_t n = 0; n < topology._nodes.size(); ++n)
+            {
+                for (int cpu : topology._nodes[n].cpus)
+                {
+                    if (static_cast<size_t>(cpu) >= topology._cpuNodes.size())
+                    {
+                        topology._cpuNodes.resize(cpu + 1, 0);
+                    }
+
+                    topology._cpuNodes[cpu] = n;
+                }
+            }
+
+            return topology;
+        }
+
+        [[nodiscard]]
+        inline size_t nodeCount() const noexcept { return _nodes.size(); }
+
+        // CPUs of the n-th node, empty when unknown (single node fallback)
+        [[nodiscard]]
+        inline const std::vector<int>& cpus(size_t n) const noexcept
+        {
+            return _nodes[n].cpus;
+        }
+
+        // index of the node of a CPU, 0 when unknown
+        [[nodiscard]]
+        inline size_t nodeOf(int cpu) const noexcept
+        {
+            return (cpu >= 0 && static_cast<size_t>(cpu) < _cpuNodes.size()) ?
+                _cpuNodes[cpu] : 0;
+        }
+
+        // node of the CPU running the calling thread
+        [[nodiscard]]
+        inline size_t currentNode() const noexcept
+        {
+            return (_nodes.size() > 1) ? nodeOf(::sched_getcpu()) : 0;
+        }
+
+        // "0-3,8,10-11" -> {0, 1, 2, 3, 8, 10, 11}
+        [[nodiscard]]
+        static std::vector<int> parseCpuList(std::string_view cpuList)
+        {
+            std::vector<int> res;
+
+            while (!cpuList.empty())
+            {
+                auto comma = std::min(cpuList.find(','), cpuList.size());
+                auto range = cpuList.substr(0, comma);
+                auto dash = range.find('-');
+
+                cpuList.remove_prefix(std::min(comma + 1, cpuList.size()));
+
+                if (range.empty() || range.find_first_not_of("0123456789-\n ")
+                                     != std::string_view::npos)
+                {
+                    continue;
+                }
+
+                int first = std::stoi(std::string(range.substr(0, dash)));
+                int last = (dash == std::string_view::npos) ?
+                    first : std::stoi(std::string(range.substr(dash + 1)));
+
+                for (int cpu = first; cpu <= last; ++cpu)
+                {
+                    res.push_back(cpu);
+                }
+            }
+
+            return res;
+        }
+
+    private :
+        struct Node
+        {
+            size_t id;
+            std::vector<int> cpus;
+        };
+
+        std::vector<Node> _nodes;
+        std::vector<size_t> _cpuNodes; // node index of each CPU
+    };
+
+    /* one copy of a read-only tree per NUMA node : each copy is made by a
+       thread bound to the CPUs of its node, so that its memory is placed on
+       that node by the first-touch policy of the kernel. Queries use the
+       copy of the node running the calling thread */
+    template <typename Replica = FrozenSuffixTree<>>
+    class NumaReplicatedSuffixTree
+    {
+    public :
+        explicit NumaReplicatedSuffixTree(const Replica& tree,
+                                          NumaTopology topology = NumaTopology::detect()) :
+            _topology(std::move(topology)),
+            _replicas(_topology.nodeCount())
+        {
+            std::vector<std::thread> threads;
+
+            threads.reserve(_replicas.size());
+
+            for (size_t n = 0; n < _replicas.size(); ++n)
+            {
+                threads.emplace_back([this, &tree, n]
+                {
+                    bindTo(_topology.cpus(n));
+                    _replicas[n] = std::make_unique<const Replica>(tree);
+                });
+            }
+
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+        }
+
+        [[nodiscard]]
+        inline const NumaTopology& topology() const noexcept { return _topology; }
+
+        [[nodiscard]]
+        inline size_t replicaCount() const noexcept { return _replicas.size(); }
+
+        [[nodiscard]]
+        inline const Replica& replica(size_t n) const noexcept { return *_replicas[n]; }
+
+        // copy of the node running the calling thread
+        [[nodiscard]]
+        inline const Replica& local() const noexcept
+        {
+            return *_replicas[_topology.currentNode()];
+        }
+
+        [[nodiscard]]
+        inline bool search(std::string_view word) const
+        {
+            return local().search(word);
+        }
+
+        [[nodiscard]]
+        inline bool endsWith(std::string_view suffix) const
+        {
+            return local().endsWith(suffix);
+        }
+
+    private :
+        NumaTopology _topology;
+        std::vector<std::unique_ptr<const Replica>> _replicas;
+
+        // best effort, the copy is still made when the CPUs are not allowed
+        static void bindTo(const std::vector<int>& cpus) noexcept
+        {
+            if (cpus.empty())
+            {
+                return;
+            }
+
+            cpu_set_t set;
+
+            CPU_ZERO(&set);
+
+            for (int cpu : cpus)
+            {
+                if (cpu < CPU_SETSIZE)
+                {
+                    CPU_SET(cpu, &set);
+                }
+            }
+
+            ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,322 @@
+#ifndef PARALLEL_OPERATIONS_HPP_
+# define PARALLEL_OPERATIONS_HPP_
+
+# include <vector>
+# include <deque>
+# include <thread>
+# include <mutex>
+# include <condition_variable>
+# include <functional>
+# include <future>
+# include <memory>
+# include <atomic>
+# include <utility>
+# include <type_traits>
+
+# include "CompressedSuffixTree.hpp"
+# include "ThreadPool.hpp"
+
+/* copy, comparison and destruction of large trees spread over a thread pool,
+   one task per subtree of the root. The trees mustn't be modified meanwhile.
+   Nodes are only allocated and freed from several threads with
+   std::allocator : another allocator (e.g. a std::pmr::memory_resource, which
+   may not be synchronized) is only used by the calling thread, copies and
+   destructions being then sequential */
+namespace container
+{
+    namespace detail
+    {
+        template <typename Tree>
+        using NodeOf_t = typename std::decay_t<
+            decltype(TreeAccess::rootPointer(std::declval<Tree&>()))>::element_type;
+
+        // whether the nodes of the tree may be allocated and freed by any thread
+        template <typename Tree>
+        inline constexpr bool concurrentAllocator_v =
+            std::is_same_v<typename Tree::allocator_type, std::allocator<char>>;
+    }
+
+    // same result as the copy constructor
+    template <typename Tree>
+    [[nodiscard]]
+    Tree parallelCopy(const Tree& other, ThreadPool& pool)
+    {
+        if constexpr (!detail::concurrentAllocator_v<Tree>)
+        {
+            return Tree(other);
+        }
+
+        using Node_t = detail::NodeOf_t<Tree>;
+
+        const auto& rootOther = detail::TreeAccess::rootPointer(other);
+        Tree res(std::allocator_traits<typename Tree::allocator_type>::
+                 select_on_container_copy_construction(other.get_allocator()));
+
+        if (!rootOther)
+        {
+            return res;
+        }
+
+        auto root = detail::TreeAccess::makeNode(res);
+        std::vector<std::shared_ptr<Node_t>> children(rootOther->childNodes.size());
+        std::vector<std::future<void>> futures;
+        size_t n = 0;
+
+        root->copyFields(*rootOther);
+        futures.reserve(children.size());
+
+        for (const auto& [_, childNodeOther] : rootOther->childNodes)
+        {
+            futures.push_back(pool.submit([&children, n, &childNodeOther, &res]
+            {
+                children[n] = Node_t::deepCopy(childNodeOther, res.get_allocator());
+            }));
+
+            ++n;
+        }
+
+        pool.wait(futures);
+
+        for (auto& childNode : children)
+        {
+            root->childNodes.emplace(childNode->s, std::move(childNode));
+        }
+
+        detail::TreeAccess::adopt(res, other, std::move(root));
+
+        return res;
+    }
+
+    // same result as operator==, the subtrees stop at the first difference found
+    template <typename Tree>
+    [[nodiscard]]
+    bool parallelEqual(const Tree& lhs, const Tree& rhs, ThreadPool& pool)
+    {
+        if (lhs.size() != rhs.size()
+            || lhs.wordCount() != rhs.wordCount()
+            || lhs.fingerprint() != rhs.fingerprint()
+            || lhs.empty() != rhs.empty())
+        {
+            return false;
+        }
+        else if (lhs.empty())
+        {
+            return true;
+        }
+
+        using Node_t = detail::NodeOf_t<Tree>;
+
+        const auto& root = detail::TreeAccess::rootPointer(lhs);
+        const auto& rootOther = detail::TreeAccess::rootPointer(rhs);
+
+        if (!root->sameFields(*rootOther))
+        {
+            return false;
+        }
+
+        std::atomic<bool> equal = true;
+        std::vector<std::future<void>> futures;
+
+        futures.reserve(root->childNodes.size());
+
+        for (const auto& [sv, childNode] : root->childNodes)
+        {
+            auto it = rootOther->childNodes.find(sv);
+
+            if (it == rootOther->childNodes.cend())
+            {
+                equal = false;
+
+                break;
+            }
+
+            futures.push_back(pool.submit([&equal, &childNode, &childNodeOther = it->second]
+            {
+                if (equal.load(std::memory_order_relaxed)
+                    && !Node_t::deepEqual(childNode, childNodeOther))
+                {
+                    equal.store(false, std::memory_order_relaxed);
+                }
+            }));
+        }
+
+        pool.wait(futures);
+
+        return equal;
+    }
+
+    /* empties the tree, its subtrees being released in parallel. Nodes still
+       shared with another owner are left to it */
+    template <typename Tree>
+    void parallelDestroy(Tree& tree, ThreadPool& pool)
+    {
+        if constexpr (!detail::concurrentAllocator_v<Tree>)
+        {
+            tree.clear();
+
+            return;
+        }
+
+        using Node_t = detail::NodeOf_t<Tree>;
+
+        auto root = detail::TreeAccess::rootPointer(tree);
+
+        tree.clear();
+
+        if (!root || root.use_count() > 1)
+        {
+            return;
+        }
+
+        std::vector<std::shared_ptr<Node_t>> children;
+        std::vector<std::future<void>> futures;
+
+        children.reserve(root->childNodes.size());
+
+        for (const auto& [_, childNode] : root->childNodes)
+        {
+            children.push_back(childNode);
+        }
+
+        // the children are only owned by the vector now
+        root.reset();
+        futures.reserve(children.size());
+
+        for (auto& childNode : children)
+        {
+            futures.push_back(pool.submit([&childNode] { childNode.reset(); }));
+        }
+
+        pool.wait(futures);
+    }
+
+    /* destroys retired trees on a thread of its own, so that replacing a large
+       tree costs its owner a move only. With a pool, each tree is destroyed by
+       "parallelDestroy". Pending trees are destroyed by the destructor.
+       A tree without std::allocator is destroyed by "retire" itself, its
+       allocator being possibly used by its owner meanwhile */
+    class BackgroundReclaimer
+    {
+    public :
+        explicit BackgroundReclaimer(ThreadPool* pool = nullptr) :
+            _pool(pool),
+            _thread([this] { work(); })
+        { }
+
+        BackgroundReclaimer(const BackgroundReclaimer&) = delete;
+        BackgroundReclaimer& operator=(const BackgroundReclaimer&) = delete;
+
+        ~BackgroundReclaimer()
+        {
+            {
+                std::lock_guard lock(_mutex);
+
+                _stop = true;
+            }
+
+            _condition.notify_all();
+            _thread.join();
+        }
+
+        // the tree is left empty
+        template <typename Tree>
+        void retire(Tree&& tree)
+        {
+            static_assert(!std::is_lvalue_reference_v<Tree>,
+                          "trees must be moved to be retired");
+
+            if constexpr (!detail::concurrentAllocator_v<Tree>)
+            {
+                tree.clear();
+
+                return;
+            }
+
+            auto retired = std::make_shared<Tree>(std::move(tree));
+            auto pool = _pool;
+
+            push([retired, pool]
+            {
+                if (pool)
+                {
+                    parallelDestroy(*retired, *pool);
+                }
+            });
+        }
+
+        // number of trees not destroyed yet
+        [[nodiscard]]
+        size_t pending() const
+        {
+            std::lock_guard lock(_mutex);
+
+            return _tasks.size() + _running;
+        }
+
+        // waits until every retired tree is destroyed
+        void drain()
+        {
+            std::unique_lock lock(_mutex);
+
+            _idle.wait(lock, [this] { return _tasks.empty() && !_running; });
+        }
+
+    private :
+        ThreadPool* _pool = nullptr;
+        mutable std::mutex _mutex;
+        std::condition_variable _condition;
+        std::condition_variable _idle;
+        std::deque<std::function<void()>> _tasks; // each one owns a tree
+        size_t _running = 0;
+        bool _stop = false;
+        std::thread _thread; // started last
+
+        void push(std::function<void()> task)
+        {
+            {
+                std::lock_guard lock(_mutex);
+
+                _tasks.push_back(std::move(task));
+            }
+
+            _condition.notify_one();
+        }
+
+        void work()
+        {
+            for (;;)
+            {
+                std::function<void()> task;
+
+                {
+                    std::unique_lock lock(_mutex);
+
+                    _condition.wait(lock, [this] { return _stop || !_tasks.empty(); });
+
+                    if (_tasks.empty())
+                    {
+                        return;
+                    }
+
+                    task = std::move(_tasks.front());
+                    _tasks.pop_front();
+                    ++_running;
+                }
+
+                task();
+                // the last owner of the tree
+                task = nullptr;
+
+                {
+                    std::lock_guard lock(_mutex);
+
+                    --_running;
+                }
+
+                _idle.notify_all();
+            }
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,491 @@
+#ifndef PATTERN_HPP_
+# define PATTERN_HPP_
+
+# include <vector>
+# include <bitset>
+# include <string>
+# include <string_view>
+# include <stdexcept>
+# include <utility>
+# include <cstdint>
+# include <cstddef>
+
+namespace container
+{
+    /* glob or restricted regular expression compiled to a Thompson automaton,
+       whose active states are kept in a bitset while reading a string.
+       Patterns match whole strings, byte by byte :
+         glob  : * (any string), ? (any byte), [abc], [a-z], [!a-z] or [^a-z],
+                 \ escaping the next byte
+         regex : . (any byte), [...] classes as for globs with ^ only, (...),
+                 | * + ?, \ escaping the next byte
+       Invalid patterns throw std::invalid_argument */
+    class Pattern
+    {
+    public :
+        using StateSet = std::vector<std::uint64_t>;
+
+        [[nodiscard]]
+        static Pattern glob(std::string_view glob)
+        {
+            Pattern pattern;
+            Parser parser(pattern, glob);
+
+            pattern.finish(parser.glob());
+
+            return pattern;
+        }
+
+        [[nodiscard]]
+        static Pattern regex(std::string_view regex)
+        {
+            Pattern pattern;
+            Parser parser(pattern, regex);
+
+            pattern.finish(parser.regex());
+
+            return pattern;
+        }
+
+        [[nodiscard]]
+        inline size_t stateCount() const noexcept { return _states.size(); }
+
+        // active states before reading anything
+        [[nodiscard]]
+        inline const StateSet& start() const noexcept { return _start; }
+
+        // states reached from "from" by reading c, false when there is none
+        bool step(const StateSet& from, char c, StateSet& to) const
+        {
+            bool any = false;
+
+            to.assign(_start.size(), 0);
+
+            for (size_t word = 0; word < from.size(); ++word)
+            {
+                for (auto bits = from[word]; bits; bits &= bits - 1)
+                {
+                    const auto& state = _states[word * 64 + countTrailingZeros(bits)];
+
+                    if (state.kind != Kind::Char
+                        || !state.chars.test(static_cast<unsigned char>(c)))
+                    {
+                        continue;
+                    }
+
+                    const auto& closure = _closures[state.out[0]];
+
+                    for (size_t n = 0; n < to.size(); ++n)
+                    {
+                        to[n] |= closure[n];
+                    }
+
+                    any = true;
+                }
+            }
+
+            return any;
+        }
+
+        [[nodiscard]]
+        inline bool accepts(const StateSet& states) const noexcept
+        {
+            return (states[_match / 64] >> (_match % 64)) & 1;
+        }
+
+        [[nodiscard]]
+        bool matches(std::string_view s) const
+        {
+            StateSet states = _start;
+            StateSet next;
+
+            for (char c : s)
+            {
+                if (!step(states, c, next))
+                {
+                    return false;
+                }
+
+                states.swap(next);
+            }
+
+            return accepts(states);
+        }
+
+    private :
+        enum class Kind : unsigned char
+        {
+            Char, // reads a byte of "chars"
+            Split, // goes to both outs without reading
+            Empty, // goes to out[0] without reading
+            Match
+        };
+
+        struct State
+        {
+            Kind kind;
+            std::bitset<256> chars;
+            int out[2] = {-1, -1};
+        };
+
+        // automaton being built, whose outs are still to be connected
+        struct Fragment
+        {
+            int start;
+            std::vector<std::pair<int, int>> outs; // (state, out index)
+        };
+
+        std::vector<State> _states;
+        std::vector<StateSet> _closures; // states reached from each one without reading
+        StateSet _start;
+        size_t _match = 0;
+
+        Pattern() = default;
+
+        [[nodiscard]]
+        static int countTrailingZeros(std::uint64_t bits) noexcept
+        {
+            return __builtin_ctzll(bits);
+        }
+
+        int addState(Kind kind, const std::bitset<256>& chars = {})
+        {
+            _states.push_back({kind, chars});
+
+            return static_cast<int>(_states.size() - 1);
+        }
+
+        void patch(const Fragment& fragment, int state)
+        {
+            for (auto [from, n] : fragment.outs)
+            {
+                _states[from].out[n] = state;
+            }
+        }
+
+        Fragment chars(const std::bitset<256>& chars)
+        {
+            int state = addState(Kind::Char, chars);
+
+            return {state, {{state, 0}}};
+        }
+
+        Fragment empty()
+        {
+            int state = addState(Kind::Empty);
+
+            return {state, {{state, 0}}};
+        }
+
+        Fragment concatenate(Fragment lhs, Fragment rhs)
+        {
+            patch(lhs, rhs.start);
+
+            return {lhs.start, std::move(rhs.outs)};
+        }
+
+        Fragment alternate(Fragment lhs, Fragment rhs)
+        {
+            int state = addState(Kind::Split);
+
+            _states[state].out[0] = lhs.start;
+            _states[state].out[1] = rhs.start;
+            lhs.outs.insert(lhs.outs.end(), rhs.outs.cbegin(), rhs.outs.cend());
+
+            return {state, std::move(lhs.outs)};
+        }
+
+        // op is one of '*', '+' or '?'
+        Fragment repeat(Fragment fragment, char op)
+        {
+            int state = addState(Kind::Split);
+
+            _states[state].out[0] = fragment.start;
+
+            if (op == '?')
+            {
+                fragment.outs.emplace_back(state, 1);
+
+                return {state, std::move(fragment.outs)};
+            }
+
+            patch(fragment, state);
+
+            return {(op == '*') ? state : fragment.start, {{state, 1}}};
+        }
+
+        void finish(const Fragment& fragment)
+        {
+            int match = addState(Kind::Match);
+
+            patch(fragment, match);
+            _match = static_cast<size_t>(match);
+
+            size_t words = (_states.size() + 63) / 64;
+
+            _closures.assign(_states.size(), StateSet(words, 0));
+
+            std::vector<int> stack;
+            std::vector<bool> visited;
+
+            // only states reading a byte and the match state are kept
+            for (size_t n = 0; n < _states.size(); ++n)
+            {
+                visited.assign(_states.size(), false);
+                stack.assign(1, static_cast<int>(n));
+
+                while (!stack.empty())
+                {
+                    int state = stack.back();
+
+                    stack.pop_back();
+
+                    if (visited[state])
+                    {
+                        continue;
+                    }
+
+                    visited[state] = true;
+
+                    switch (_states[state].kind)
+                    {
+                        case Kind::Split:
+                            stack.push_back(_states[state].out[1]);
+                            [[fallthrough]];
+                        case Kind::Empty:
+                            stack.push_back(_states[state].out[0]);
+                            break;
+                        default:
+                            _closures[n][state / 64] |= std::uint64_t(1) << (state % 64);
+                    }
+                }
+            }
+
+            _start = _closures[fragment.start];
+        }
+
+        class Parser
+        {
+        public :
+            Parser(Pattern& pattern, std::string_view s) noexcept :
+                _pattern(pattern),
+                _s(s)
+            { }
+
+            Fragment glob()
+            {
+                std::bitset<256> any;
+                Fragment res = _pattern.empty();
+
+                any.set();
+
+                while (_pos < _s.size())
+                {
+                    char c = _s[_pos++];
+
+                    switch (c)
+                    {
+                        case '*':
+                            res = _pattern.concatenate(
+                                std::move(res), _pattern.repeat(_pattern.chars(any), '*'));
+                            break;
+                        case '?':
+                            res = _pattern.concatenate(std::move(res), _pattern.chars(any));
+                            break;
+                        case '[':
+                            res = _pattern.concatenate(
+                                std::move(res), _pattern.chars(charClass(true)));
+                            break;
+                        default:
+                            res = _pattern.concatenate(
+                                std::move(res), _pattern.chars(single(escaped(c))));
+                    }
+                }
+
+                return res;
+            }
+
+            Fragment regex()
+            {
+                auto res = alternation();
+
+                if (_pos < _s.size())
+                {
+                    fail("unmatched ')'");
+                }
+
+                return res;
+            }
+
+        private :
+            Pattern& _pattern;
+            std::string_view _s;
+            size_t _pos = 0;
+
+            [[noreturn]]
+            void fail(const char* what) const
+            {
+                throw std::invalid_argument(
+                    std::string("invalid pattern at ") + std::to_string(_pos)
+                    + " : " + what);
+            }
+
+            [[nodiscard]]
+            static std::bitset<256> single(char c)
+            {
+                std::bitset<256> res;
+
+                res.set(static_cast<unsigned char>(c));
+
+                return res;
+            }
+
+            // c has just been read, the escaped byte when it is a backslash
+            char escaped(char c)
+            {
+                if (c != '\\')
+                {
+                    return c;
+                }
+
+                if (_pos == _s.size())
+                {
+                    fail("trailing '\\'");
+                }
+
+                return _s[_pos++];
+            }
+
+            // the '[' has just been read
+            std::bitset<256> charClass(bool glob)
+            {
+                std::bitset<256> res;
+                bool negated = _pos < _s.size()
+                    && (_s[_pos] == '^' || (glob && _s[_pos] == '!'));
+
+                _pos += negated;
+
+                // a ']' first is a member of the class
+                for (bool first = true; ; first = false)
+                {
+                    if (_pos == _s.size())
+                    {
+                        fail("missing ']'");
+                    }
+
+                    char c = _s[_pos++];
+
+                    if (c == ']' && !first)
+                    {
+                        break;
+                    }
+
+                    auto low = static_cast<unsigned char>(escaped(c));
+                    auto high = low;
+
+                    if (_pos + 1 < _s.size() && _s[_pos] == '-' && _s[_pos + 1] != ']')
+                    {
+                        ++_pos;
+                        high = static_cast<unsigned char>(escaped(_s[_pos++]));
+
+                        if (high < low)
+                        {
+                            fail("invalid range");
+                        }
+                    }
+
+                    for (unsigned n = low; n <= high; ++n)
+                    {
+                        res.set(n);
+                    }
+                }
+
+                return negated ? ~res : res;
+            }
+
+            [[nodiscard]]
+            inline bool atBranchEnd() const noexcept
+            {
+                return _pos == _s.size() || _s[_pos] == '|' || _s[_pos] == ')';
+            }
+
+            Fragment alternation()
+            {
+                auto res = concatenation();
+
+                while (_pos < _s.size() && _s[_pos] == '|')
+                {
+                    ++_pos;
+                    res = _pattern.alternate(std::move(res), concatenation());
+                }
+
+                return res;
+            }
+
+            Fragment concatenation()
+            {
+                if (atBranchEnd())
+                {
+                    return _pattern.empty();
+                }
+
+                auto res = repetition();
+
+                while (!atBranchEnd())
+                {
+                    res = _pattern.concatenate(std::move(res), repetition());
+                }
+
+                return res;
+            }
+
+            Fragment repetition()
+            {
+                auto res = atom();
+
+                while (_pos < _s.size()
+                       && (_s[_pos] == '*' || _s[_pos] == '+' || _s[_pos] == '?'))
+                {
+                    res = _pattern.repeat(std::move(res), _s[_pos++]);
+                }
+
+                return res;
+            }
+
+            Fragment atom()
+            {
+                char c = _s[_pos++];
+
+                switch (c)
+                {
+                    case '(':
+                    {
+                        auto res = alternation();
+
+                        if (_pos == _s.size() || _s[_pos] != ')')
+                        {
+                            fail("missing ')'");
+                        }
+
+                        ++_pos;
+
+                        return res;
+                    }
+                    case '*':
+                    case '+':
+                    case '?':
+                        --_pos;
+                        fail("nothing to repeat");
+                    case '.':
+                        return _pattern.chars(std::bitset<256>().set());
+                    case '[':
+                        return _pattern.chars(charClass(false));
+                    default:
+                        return _pattern.chars(single(escaped(c)));
+                }
+            }
+        };
+    };
+}
+
+#endif
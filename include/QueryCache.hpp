@@ -0,0 +1,217 @@
+#ifndef QUERY_CACHE_HPP_
+# define QUERY_CACHE_HPP_
+
+# include <vector>
+# include <string>
+# include <string_view>
+# include <unordered_map>
+# include <mutex>
+# include <atomic>
+# include <memory>
+# include <functional>
+# include <algorithm>
+# include <cstdint>
+# include <cstddef>
+
+# include "CompressedSuffixTree.hpp"
+
+namespace container
+{
+    /* bounded cache of the results of "search" and "endsWith" in front of a
+       tree, split in shards each protected by its own mutex and evicting
+       entries with the CLOCK algorithm. Each entry keeps the generation of
+       the tree it was computed at and isn't served once the tree has been
+       modified. As for the tree, queries may run concurrently but not while
+       the tree is modified */
+    template <typename Tree = CompressedSuffixTree<>>
+    class QueryCache
+    {
+    public :
+        explicit QueryCache(const Tree& tree, size_t capacity = 4096, size_t shardCount = 16) :
+            _tree(tree),
+            _shards(std::max<size_t>(shardCount, 1))
+        {
+            size_t shardCapacity = std::max<size_t>(capacity / _shards.size(), 1);
+
+            for (auto& shard : _shards)
+            {
+                shard = std::make_unique<Shard>();
+                shard->slots.resize(shardCapacity);
+                shard->index.reserve(shardCapacity);
+            }
+        }
+
+        [[nodiscard]]
+        bool search(std::string_view word) const
+        {
+            return lookup(Operation::Search, word);
+        }
+
+        [[nodiscard]]
+        bool endsWith(std::string_view suffix) const
+        {
+            return lookup(Operation::EndsWith, suffix);
+        }
+
+        [[nodiscard]]
+        inline size_t hits() const noexcept { return _hits.load(std::memory_order_relaxed); }
+
+        // queries computed by the tree, stale entries included
+        [[nodiscard]]
+        inline size_t misses() const noexcept { return _misses.load(std::memory_order_relaxed); }
+
+        [[nodiscard]]
+        inline size_t capacity() const noexcept
+        {
+            return _shards.size() * _shards[0]->slots.size();
+        }
+
+        // number of entries, stale ones included
+        [[nodiscard]]
+        size_t size() const
+        {
+            size_t res = 0;
+
+            for (const auto& shard : _shards)
+            {
+                std::lock_guard lock(shard->mutex);
+
+                res += shard->index.size();
+            }
+
+            return res;
+        }
+
+        // removes all entries and resets the counters
+        void clear()
+        {
+            for (auto& shard : _shards)
+            {
+                std::lock_guard lock(shard->mutex);
+
+                shard->index.clear();
+                std::fill(shard->slots.begin(), shard->slots.end(), Slot{});
+                shard->hand = 0;
+            }
+
+            _hits.store(0, std::memory_order_relaxed);
+            _misses.store(0, std::memory_order_relaxed);
+        }
+
+    private :
+        enum class Operation : char
+        {
+            Search = 's',
+            EndsWith = 'e'
+        };
+
+        struct Slot
+        {
+            std::string key; // operation followed by the query, empty when unused
+            std::uint64_t generation = 0;
+            bool result = false;
+            bool referenced = false; // second chance of CLOCK
+        };
+
+        struct Shard
+        {
+            mutable std::mutex mutex;
+            std::vector<Slot> slots;
+            std::unordered_map<std::string_view, size_t> index; // keys point in slots
+            size_t hand = 0;
+        };
+
+        const Tree& _tree;
+        std::vector<std::unique_ptr<Shard>> _shards;
+        mutable std::atomic<size_t> _hits = 0;
+        mutable std::atomic<size_t> _misses = 0;
+
+        bool lookup(Operation operation, std::string_view query) const
+        {
+            std::string key;
+
+            key.reserve(query.size() + 1);
+            key.push_back(static_cast<char>(operation));
+            key.append(query);
+
+            auto& shard = *_shards[std::hash<std::string>{}(key) % _shards.size()];
+            auto generation = _tree.generation();
+
+            {
+                std::lock_guard lock(shard.mutex);
+
+                if (auto it = shard.index.find(key); it != shard.index.end())
+                {
+                    auto& slot = shard.slots[it->second];
+
+                    if (slot.generation == generation)
+                    {
+                        slot.referenced = true;
+                        _hits.fetch_add(1, std::memory_order_relaxed);
+
+                        return slot.result;
+                    }
+                }
+            }
+
+            // computed without holding the shard
+            bool result = (operation == Operation::Search) ?
+                _tree.search(query) : _tree.endsWith(query);
+
+            _misses.fetch_add(1, std::memory_order_relaxed);
+
+            std::lock_guard lock(shard.mutex);
+
+            if (auto it = shard.index.find(key); it != shard.index.end())
+            {
+                auto& slot = shard.slots[it->second];
+
+                slot.generation = generation;
+                slot.result = result;
+                slot.referenced = true;
+
+                return result;
+            }
+
+            auto n = evict(shard);
+            auto& slot = shard.slots[n];
+
+            slot.key = std::move(key);
+            slot.generation = generation;
+            slot.result = result;
+            slot.referenced = false;
+            shard.index.emplace(slot.key, n);
+
+            return result;
+        }
+
+        // frees a slot, skipping once each slot referenced since the last turn
+        static size_t evict(Shard& shard)
+        {
+            for (;;)
+            {
+                auto n = shard.hand;
+                auto& slot = shard.slots[n];
+
+                shard.hand = (shard.hand + 1) % shard.slots.size();
+
+                if (slot.referenced)
+                {
+                    slot.referenced = false;
+
+                    continue;
+                }
+
+                if (!slot.key.empty())
+                {
+                    shard.index.erase(slot.key);
+                    slot.key.clear();
+                }
+
+                return n;
+            }
+        }
+    };
+}
+
+#endif
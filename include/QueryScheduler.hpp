@@ -0,0 +1,216 @@
+#ifndef QUERY_SCHEDULER_HPP_
+# define QUERY_SCHEDULER_HPP_
+
+/* coroutine lookups are only available when compiling as C++20 (or later),
+   the rest of the library stays C++17 */
+# ifdef __cpp_impl_coroutine
+
+#  include <coroutine>
+#  include <exception>
+#  include <utility>
+#  include <vector>
+#  include <type_traits>
+#  include <algorithm>
+#  include <cstddef>
+
+namespace container
+{
+    /* lazily started coroutine producing a T, resumed step by step by its
+       owner (usually a QueryScheduler) */
+    template <typename T>
+    class Task
+    {
+    public :
+        using value_type = T;
+
+        struct promise_type
+        {
+            T value{};
+            std::exception_ptr exception;
+
+            Task get_return_object() noexcept
+            {
+                return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+
+            std::suspend_always final_suspend() const noexcept { return {}; }
+
+            void return_value(T v) noexcept(std::is_nothrow_move_assignable_v<T>)
+            {
+                value = std::move(v);
+            }
+
+            void unhandled_exception() noexcept
+            {
+                exception = std::current_exception();
+            }
+        };
+
+        Task(Task&& other) noexcept :
+            _handle(std::exchange(other._handle, {}))
+        { }
+
+        Task& operator=(Task&& other) noexcept
+        {
+            if (this != &other)
+            {
+                if (_handle)
+                {
+                    _handle.destroy();
+                }
+
+                _handle = std::exchange(other._handle, {});
+            }
+
+            return *this;
+        }
+
+        ~Task()
+        {
+            if (_handle)
+            {
+                _handle.destroy();
+            }
+        }
+
+        [[nodiscard]]
+        inline bool done() const noexcept { return _handle.done(); }
+
+        // runs the coroutine until its next suspension point
+        inline void resume() { _handle.resume(); }
+
+        // the coroutine must be done
+        [[nodiscard]]
+        T result()
+        {
+            if (_handle.promise().exception)
+            {
+                std::rethrow_exception(_handle.promise().exception);
+            }
+
+            return std::move(_handle.promise().value);
+        }
+
+        // runs the coroutine to its end without interleaving
+        [[nodiscard]]
+        T get()
+        {
+            while (!done())
+            {
+                resume();
+            }
+
+            return result();
+        }
+
+    private :
+        std::coroutine_handle<promise_type> _handle;
+
+        explicit Task(std::coroutine_handle<promise_type> handle) noexcept :
+            _handle(handle)
+        { }
+    };
+
+    /* starts loading the cache lines of one or two independent addresses and
+       suspends, so that the scheduler runs other lookups while the memory is
+       fetched. A null address is skipped */
+    struct Prefetch
+    {
+        const void* address;
+        const void* other = nullptr;
+
+        bool await_ready() const noexcept
+        {
+            if (address)
+            {
+                __builtin_prefetch(address);
+            }
+
+            if (other)
+            {
+                __builtin_prefetch(other);
+            }
+
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<>) const noexcept
+        { }
+
+        void await_resume() const noexcept
+        { }
+    };
+
+    /* interleaves lookups on the calling thread : up to "width" tasks are in
+       flight and resumed in turn, each one suspending after having
+       prefetched the next memory it needs */
+    class QueryScheduler
+    {
+    public :
+        explicit QueryScheduler(size_t width = 16) :
+            _width(std::max<size_t>(width, 1))
+        { }
+
+        [[nodiscard]]
+        inline size_t width() const noexcept { return _width; }
+
+        /* runs makeTask(n) for n within [0, count), returns the result of each
+           task at its index */
+        template <typename MakeTask>
+        auto run(size_t count, MakeTask makeTask)
+            -> std::vector<typename std::invoke_result_t<MakeTask, size_t>::value_type>
+        {
+            using Task_t = std::invoke_result_t<MakeTask, size_t>;
+
+            std::vector<typename Task_t::value_type> res(count);
+            std::vector<std::pair<size_t, Task_t>> tasks;
+            size_t next = 0;
+
+            tasks.reserve(std::min(_width, count));
+
+            while (next < count || !tasks.empty())
+            {
+                while (tasks.size() < _width && next < count)
+                {
+                    tasks.emplace_back(next, makeTask(next));
+                    ++next;
+                }
+
+                for (size_t n = 0; n < tasks.size();)
+                {
+                    auto& [index, task] = tasks[n];
+
+                    task.resume();
+
+                    if (!task.done())
+                    {
+                        ++n;
+
+                        continue;
+                    }
+
+                    res[index] = task.result();
+
+                    // the last task takes the place of the finished one
+                    if (n + 1 < tasks.size())
+                    {
+                        tasks[n] = std::move(tasks.back());
+                    }
+
+                    tasks.pop_back();
+                }
+            }
+
+            return res;
+        }
+
+    private :
+        size_t _width;
+    };
+}
+
+# endif
+
+#endif
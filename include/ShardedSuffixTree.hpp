@@ -0,0 +1,305 @@
+#ifndef SHARDED_SUFFIX_TREE_HPP_
+# define SHARDED_SUFFIX_TREE_HPP_
+
+# include <vector>
+# include <string>
+# include <string_view>
+# include <memory>
+# include <shared_mutex>
+# include <mutex>
+# include <functional>
+
+# include "CompressedSuffixTree.hpp"
+# include "ThreadPool.hpp"
+
+namespace container
+{
+    /* words are partitioned by hash over independent trees, each one guarded
+       by its own reader / writer lock. A word is stored in a single shard so
+       "search" reaches one shard while "endsWith" has to ask all of them.
+       Batch operations run one task per shard on the thread pool */
+    template <typename Tree = CompressedSuffixTree<>>
+    class ShardedSuffixTree
+    {
+    public :
+        explicit ShardedSuffixTree(size_t shardCount, ThreadPool& pool) :
+            _pool(&pool)
+        {
+            init(shardCount);
+        }
+
+        explicit ShardedSuffixTree(
+            size_t shardCount = std::max(1u, std::thread::hardware_concurrency())) :
+            _ownPool(std::make_unique<ThreadPool>(shardCount)),
+            _pool(_ownPool.get())
+        {
+            init(shardCount);
+        }
+
+        ShardedSuffixTree(const ShardedSuffixTree&) = delete;
+        ShardedSuffixTree& operator=(const ShardedSuffixTree&) = delete;
+
+        [[nodiscard]]
+        inline size_t shardCount() const noexcept { return _shards.size(); }
+
+        // words equal once normalized by the policy of Tree share their shard
+        [[nodiscard]]
+        size_t shardOf(std::string_view word) const
+        {
+            std::string buffer;
+
+            word = detail::TreeAccess::normalizedKey<Tree>(word, buffer);
+
+            return std::hash<std::string_view>{}(word) % _shards.size();
+        }
+
+        [[nodiscard]]
+        bool empty() const
+        {
+            for (const auto& shard : _shards)
+            {
+                std::shared_lock lock(shard->mutex);
+
+                if (!shard->tree.empty())
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        [[nodiscard]]
+        size_t size() const
+        {
+            return accumulate([](const Tree& tree) { return tree.size(); });
+        }
+
+        [[nodiscard]]
+        size_t wordCount() const
+        {
+            return accumulate([](const Tree& tree) { return tree.wordCount(); });
+        }
+
+        [[nodiscard]]
+        bool search(std::string_view word) const
+        {
+            const auto& shard = *_shards[shardOf(word)];
+            std::shared_lock lock(shard.mutex);
+
+            return shard.tree.search(word);
+        }
+
+        [[nodiscard]]
+        bool endsWith(std::string_view suffix) const
+        {
+            for (const auto& shard : _shards)
+            {
+                std::shared_lock lock(shard->mutex);
+
+                if (shard->tree.endsWith(suffix))
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        bool insert(std::string_view word)
+        {
+            auto& shard = *_shards[shardOf(word)];
+            std::unique_lock lock(shard.mutex);
+
+            return shard.tree.insert(word);
+        }
+
+        bool erase(std::string_view word)
+        {
+            auto& shard = *_shards[shardOf(word)];
+            std::unique_lock lock(shard.mutex);
+
+            return shard.tree.erase(word);
+        }
+
+        void clear()
+        {
+            for (auto& shard : _shards)
+            {
+                std::unique_lock lock(shard->mutex);
+
+                shard->tree.clear();
+            }
+        }
+
+        // builds every shard in parallel, returns the number of stored words
+        template <typename Container>
+        size_t insertBatch(const Container& words)
+        {
+            auto groups = groupByShard(words);
+            std::vector<size_t> counts(_shards.size(), 0);
+
+            forEachShard(groups, [&](size_t index)
+            {
+                auto& shard = *_shards[index];
+                std::unique_lock lock(shard.mutex);
+
+                for (auto [_, word] : groups[index])
+                {
+                    counts[index] += shard.tree.insert(word);
+                }
+            });
+
+            return sum(counts);
+        }
+
+        template <typename Container>
+        [[nodiscard]]
+        std::vector<bool> searchBatch(const Container& words) const
+        {
+            auto groups = groupByShard(words);
+            std::vector<char> res(std::size(words), false);
+
+            forEachShard(groups, [&](size_t index)
+            {
+                const auto& shard = *_shards[index];
+                std::shared_lock lock(shard.mutex);
+
+                for (auto [n, word] : groups[index])
+                {
+                    res[n] = shard.tree.search(word);
+                }
+            });
+
+            return {res.cbegin(), res.cend()};
+        }
+
+        // each shard answers all suffixes, results are gathered afterwards
+        template <typename Container>
+        [[nodiscard]]
+        std::vector<bool> endsWithBatch(const Container& suffixes) const
+        {
+            std::vector<std::vector<char>> shardRes(_shards.size());
+            std::vector<std::future<void>> futures;
+
+            futures.reserve(_shards.size());
+
+            for (size_t index = 0; index < _shards.size(); ++index)
+            {
+                futures.push_back(_pool->submit([&, index]
+                {
+                    const auto& shard = *_shards[index];
+                    std::shared_lock lock(shard.mutex);
+
+                    shardRes[index].reserve(std::size(suffixes));
+
+                    for (const auto& suffix : suffixes)
+                    {
+                        shardRes[index].push_back(shard.tree.endsWith(suffix));
+                    }
+                }));
+            }
+
+            _pool->wait(futures);
+
+            std::vector<bool> res(std::size(suffixes), false);
+
+            for (const auto& values : shardRes)
+            {
+                for (size_t n = 0; n < values.size(); ++n)
+                {
+                    res[n] = res[n] || values[n];
+                }
+            }
+
+            return res;
+        }
+
+    private :
+        struct Shard
+        {
+            mutable std::shared_mutex mutex;
+            Tree tree;
+        };
+
+        std::unique_ptr<ThreadPool> _ownPool;
+        ThreadPool* _pool = nullptr;
+        std::vector<std::unique_ptr<Shard>> _shards;
+
+        void init(size_t shardCount)
+        {
+            shardCount = std::max<size_t>(shardCount, 1);
+            _shards.reserve(shardCount);
+
+            for (size_t n = 0; n < shardCount; ++n)
+            {
+                _shards.push_back(std::make_unique<Shard>());
+            }
+        }
+
+        [[nodiscard]]
+        static size_t sum(const std::vector<size_t>& values) noexcept
+        {
+            size_t res = 0;
+
+            for (size_t value : values)
+            {
+                res += value;
+            }
+
+            return res;
+        }
+
+        template <typename F>
+        [[nodiscard]]
+        size_t accumulate(F f) const
+        {
+            size_t res = 0;
+
+            for (const auto& shard : _shards)
+            {
+                std::shared_lock lock(shard->mutex);
+
+                res += f(shard->tree);
+            }
+
+            return res;
+        }
+
+        using Groups_t = std::vector<std::vector<std::pair<size_t, std::string_view>>>;
+
+        // words of each shard with their index in the batch
+        template <typename Container>
+        [[nodiscard]]
+        Groups_t groupByShard(const Container& words) const
+        {
+            Groups_t groups(_shards.size());
+            size_t n = 0;
+
+            for (std::string_view word : words)
+            {
+                groups[shardOf(word)].emplace_back(n++, word);
+            }
+
+            return groups;
+        }
+
+        template <typename F>
+        void forEachShard(const Groups_t& groups, F f) const
+        {
+            std::vector<std::future<void>> futures;
+
+            for (size_t index = 0; index < groups.size(); ++index)
+            {
+                if (!groups[index].empty())
+                {
+                    futures.push_back(_pool->submit([&f, index] { f(index); }));
+                }
+            }
+
+            _pool->wait(futures);
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,212 @@
+#ifndef SLIDING_WINDOW_SUFFIX_TREE_HPP_
+# define SLIDING_WINDOW_SUFFIX_TREE_HPP_
+
+# include <deque>
+# include <string>
+# include <string_view>
+# include <utility>
+# include <cstdint>
+# include <cstddef>
+# include <algorithm>
+
+# include "CompressedSuffixTree.hpp"
+
+namespace container
+{
+    /* stores words tagged with increasing sequence ids (e.g. log lines), the
+       oldest ones being expired by watermark. Words are grouped by arrival in
+       generations of at most generationSize insertions, each one being its
+       own tree : a generation entirely below the watermark is released at
+       once without erasing its suffixes, only the generation containing the
+       watermark erases its expired words one by one.
+
+       Queries ask every generation, so their number is bounded by
+       maxGenerations : when one more is needed, the two adjacent generations
+       holding the fewest insertions are merged, the oldest one excepted so
+       that it is still released at once. Sizes grow from the newest to the
+       oldest generations as in a log structured merge tree, each insertion
+       being merged O(log(window / generationSize)) times. "search" and
+       "endsWith" cost O(maxGenerations * m) for a query of length m.
+
+       A word inserted again stays alive until its last insertion expires */
+    template <template <typename...> typename Alloc = std::allocator>
+    class SlidingWindowSuffixTree
+    {
+    public :
+        explicit SlidingWindowSuffixTree(size_t generationSize = 4096,
+                                         size_t maxGenerations = 8) :
+            _generationSize(std::max<size_t>(generationSize, 1)),
+            _maxGenerations(std::max<size_t>(maxGenerations, 3))
+        { }
+
+        [[nodiscard]]
+        inline bool empty() const noexcept { return _generations.empty(); }
+
+        // nodes of all generations, a word may be stored by several of them
+        [[nodiscard]]
+        size_t size() const noexcept
+        {
+            size_t res = 0;
+
+            for (const auto& generation : _generations)
+            {
+                res += generation.tree.size();
+            }
+
+            return res;
+        }
+
+        // never more than maxGenerations
+        [[nodiscard]]
+        inline size_t generationCount() const noexcept { return _generations.size(); }
+
+        // words with a lower sequence id have been expired
+        [[nodiscard]]
+        inline std::uint64_t watermark() const noexcept { return _watermark; }
+
+        [[nodiscard]]
+        bool search(std::string_view word) const
+        {
+            return std::any_of(
+                _generations.cbegin(), _generations.cend(),
+                [word](const auto& generation) { return generation.tree.search(word); });
+        }
+
+        [[nodiscard]]
+        bool endsWith(std::string_view suffix) const
+        {
+            return std::any_of(
+                _generations.cbegin(), _generations.cend(),
+                [suffix](const auto& generation)
+                {
+                    return generation.tree.endsWith(suffix);
+                });
+        }
+
+        /* returns false if the word is empty, or if the sequence id is lower
+           than the last inserted one or than the watermark */
+        bool insert(std::uint64_t sequence, std::string_view word)
+        {
+            if (word.empty() || sequence < _watermark
+                || (!_generations.empty() && sequence < _generations.back().last))
+            {
+                return false;
+            }
+
+            if (_generations.empty()
+                || _generations.back().log.size() >= _generationSize)
+            {
+                if (_generations.size() >= _maxGenerations)
+                {
+                    mergeSmallest();
+                }
+
+                _generations.emplace_back();
+            }
+
+            auto& generation = _generations.back();
+
+            // a duplicate only moves the expiry of the word
+            if (!generation.tree.insert(word, sequence))
+            {
+                generation.tree.find(word)->get() = sequence;
+            }
+
+            generation.log.emplace_back(sequence, word);
+            generation.last = sequence;
+
+            return true;
+        }
+
+        // removes words whose sequence id is lower than watermark
+        void expire(std::uint64_t watermark)
+        {
+            if (watermark <= _watermark)
+            {
+                return;
+            }
+
+            _watermark = watermark;
+
+            // whole generations are released
+            while (!_generations.empty() && _generations.front().last < watermark)
+            {
+                _generations.pop_front();
+            }
+
+            if (_generations.empty())
+            {
+                return;
+            }
+
+            auto& generation = _generations.front();
+
+            while (!generation.log.empty()
+                   && generation.log.front().first < watermark)
+            {
+                const auto& [sequence, word] = generation.log.front();
+
+                /* only the last insertion of the word in the generation expires
+                   it, a word logged twice with the same id is already erased */
+                if (auto last = generation.tree.find(word); last && last->get() == sequence)
+                {
+                    generation.tree.erase(word);
+                }
+
+                generation.log.pop_front();
+            }
+        }
+
+        void clear() noexcept
+        {
+            _generations.clear();
+        }
+
+    private :
+        using Tree_t = CompressedSuffixTree<Alloc, std::uint64_t>;
+
+        struct Generation
+        {
+            Tree_t tree; // word -> sequence id of its last insertion
+            std::deque<std::pair<std::uint64_t, std::string>> log; // insertion order
+            std::uint64_t last = 0;
+        };
+
+        size_t _generationSize;
+        size_t _maxGenerations;
+        std::uint64_t _watermark = 0;
+        std::deque<Generation> _generations;
+
+        // merges the adjacent generations with the fewest insertions but the oldest
+        void mergeSmallest()
+        {
+            size_t best = 1;
+
+            for (size_t n = 2; n + 1 < _generations.size(); ++n)
+            {
+                if (_generations[n].log.size() + _generations[n + 1].log.size()
+                    <= _generations[best].log.size() + _generations[best + 1].log.size())
+                {
+                    best = n;
+                }
+            }
+
+            auto& older = _generations[best];
+            auto& next = _generations[best + 1];
+
+            older.tree.merge(std::move(next.tree));
+
+            // words of both generations expire with their last insertion
+            for (auto& entry : next.log)
+            {
+                older.tree.find(entry.second)->get() = entry.first;
+                older.log.push_back(std::move(entry));
+            }
+
+            older.last = next.last;
+            _generations.erase(_generations.begin() + static_cast<std::ptrdiff_t>(best) + 1);
+        }
+    };
+}
+
+#endif
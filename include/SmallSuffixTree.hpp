@@ -0,0 +1,496 @@
+#ifndef SMALL_SUFFIX_TREE_HPP_
+# define SMALL_SUFFIX_TREE_HPP_
+
+# include <array>
+# include <string_view>
+# include <initializer_list>
+# include <stdexcept>
+# include <cstdint>
+# include <cstddef>
+# include <limits>
+# include <type_traits>
+
+namespace container
+{
+    namespace detail
+    {
+        // smallest unsigned type able to represent values up to Max
+        template <size_t Max>
+        using SmallUnsigned_t = std::conditional_t<
+            (Max < std::numeric_limits<std::uint8_t>::max()),
+            std::uint8_t,
+            std::conditional_t<
+                (Max < std::numeric_limits<std::uint16_t>::max()),
+                std::uint16_t,
+                std::uint32_t>>;
+    }
+
+    /* compressed suffix tree whose nodes live in a fixed size array of the
+       object itself : edge labels are stored inline (up to MaxWordLength
+       characters) and children are linked through indexes (first child /
+       next sibling), so no allocation ever happens and trees built from
+       literal words can be constexpr.
+
+       Same semantics as CompressedSuffixTree (without values and
+       frequencies). Inserting a longer word than MaxWordLength, or a word
+       requiring more nodes than left, throws std::length_error and leaves
+       the tree unchanged */
+    template <size_t MaxWordLength, size_t NodeCapacity>
+    class SmallSuffixTree
+    {
+        static_assert(MaxWordLength > 0, "MaxWordLength cannot be null");
+        static_assert(NodeCapacity > 0, "NodeCapacity cannot be null");
+
+    public :
+        constexpr SmallSuffixTree() = default;
+
+        constexpr SmallSuffixTree(std::initializer_list<std::string_view> initList)
+        {
+            for (auto sv : initList)
+            {
+                insert(sv);
+            }
+        }
+
+        [[nodiscard]]
+        friend constexpr bool operator==(
+            const SmallSuffixTree& lhs, const SmallSuffixTree& rhs) noexcept
+        {
+            return lhs._size == rhs._size
+                && lhs._wordCount == rhs._wordCount
+                && lhs.deepEqual(root, rhs, root);
+        }
+
+        [[nodiscard]]
+        friend constexpr bool operator!=(
+            const SmallSuffixTree& lhs, const SmallSuffixTree& rhs) noexcept
+        {
+            return !(lhs == rhs);
+        }
+
+        [[nodiscard]]
+        constexpr bool empty() const noexcept { return _nodes[root].firstChild == npos; }
+
+        [[nodiscard]]
+        constexpr size_t size() const noexcept { return _size; }
+
+        [[nodiscard]]
+        constexpr size_t wordCount() const noexcept { return _wordCount; }
+
+        [[nodiscard]]
+        static constexpr size_t capacity() noexcept { return NodeCapacity; }
+
+        [[nodiscard]]
+        static constexpr size_t maxWordLength() noexcept { return MaxWordLength; }
+
+        [[nodiscard]]
+        constexpr bool search(std::string_view word) const noexcept
+        {
+            auto node = find(word);
+
+            return node != npos && _nodes[node].terminalWord;
+        }
+
+        [[nodiscard]]
+        constexpr bool endsWith(std::string_view suffix) const noexcept
+        {
+            auto node = find(suffix);
+
+            return node != npos
+                && _nodes[node].terminalCount > (_nodes[node].terminalWord ? 1 : 0);
+        }
+
+        constexpr bool insert(std::string_view word)
+        {
+            if (word.empty() || search(word))
+            {
+                return false;
+            }
+
+            if (word.size() > MaxWordLength)
+            {
+                throw std::length_error("word is longer than MaxWordLength");
+            }
+
+            for (size_t n = 0; n < word.size(); ++n)
+            {
+                if (requiredNodes(word.substr(n)) > NodeCapacity - _size)
+                {
+                    // rollback suffixes already inserted
+                    for (size_t m = 0; m < n; ++m)
+                    {
+                        erase(word.substr(m), m == 0);
+                    }
+
+                    throw std::length_error("no more node available");
+                }
+
+                insert(word.substr(n), n == 0);
+            }
+
+            return true;
+        }
+
+        constexpr bool erase(std::string_view word) noexcept
+        {
+            if (word.empty() || !search(word))
+            {
+                return false;
+            }
+
+            for (size_t n = 0; n < word.size(); ++n)
+            {
+                erase(word.substr(n), n == 0);
+            }
+
+            return true;
+        }
+
+        constexpr void clear() noexcept
+        {
+            _nodes[root] = Node{};
+            _used = 1;
+            _freeList = npos;
+            _size = 0;
+            _wordCount = 0;
+        }
+
+    private :
+        using Index_t = detail::SmallUnsigned_t<NodeCapacity + 1>;
+        using Length_t = detail::SmallUnsigned_t<MaxWordLength>;
+
+        static constexpr Index_t npos = std::numeric_limits<Index_t>::max();
+        static constexpr Index_t root = 0;
+
+        struct Node
+        {
+            char s[MaxWordLength] = {};
+            Length_t length = 0;
+            bool terminalWord = false; // true means that's node represents end of word
+            Index_t terminalCount = 0; /* could represent end of word as well as end of
+                                          suffixes from others words */
+            Index_t firstChild = npos;
+            Index_t nextSibling = npos; // next free node when unused
+
+            [[nodiscard]]
+            constexpr std::string_view label() const noexcept
+            {
+                return {s, length};
+            }
+        };
+
+        std::array<Node, NodeCapacity + 1> _nodes = {};
+        Index_t _used = 1; // nodes [0, _used) have been handed out at least once
+        Index_t _freeList = npos;
+        size_t _size = 0;
+        size_t _wordCount = 0;
+
+        [[nodiscard]]
+        static constexpr size_t commonPrefix(std::string_view lhs,
+                                             std::string_view rhs) noexcept
+        {
+            size_t n = 0;
+
+            while (n < lhs.size() && n < rhs.size() && lhs[n] == rhs[n])
+            {
+                ++n;
+            }
+
+            return n;
+        }
+
+        [[nodiscard]]
+        constexpr Index_t findChild(Index_t node, char c) const noexcept
+        {
+            auto child = _nodes[node].firstChild;
+
+            while (child != npos && _nodes[child].s[0] != c)
+            {
+                child = _nodes[child].nextSibling;
+            }
+
+            return child;
+        }
+
+        // node whose path is exactly sv, npos otherwise
+        [[nodiscard]]
+        constexpr Index_t find(std::string_view sv) const noexcept
+        {
+            if (sv.empty())
+            {
+                return npos;
+            }
+
+            Index_t node = root;
+
+            while (!sv.empty())
+            {
+                node = findChild(node, sv[0]);
+
+                if (node == npos)
+                {
+                    return npos;
+                }
+
+                auto label = _nodes[node].label();
+
+                if (commonPrefix(label, sv) < label.size())
+                {
+                    return npos;
+                }
+
+                sv.remove_prefix(label.size());
+            }
+
+            return node;
+        }
+
+        // number of nodes that inserting sv would create
+        [[nodiscard]]
+        constexpr size_t requiredNodes(std::string_view sv) const noexcept
+        {
+            Index_t node = root;
+
+            while (!sv.empty())
+            {
+                auto child = findChild(node, sv[0]);
+
+                if (child == npos)
+                {
+                    return 1;
+                }
+
+                auto label = _nodes[child].label();
+                auto endPos = commonPrefix(label, sv);
+
+                if (endPos < label.size())
+                {
+                    return (endPos < sv.size()) ? 2 : 1;
+                }
+
+                sv.remove_prefix(endPos);
+                node = child;
+            }
+
+            return 0;
+        }
+
+        [[nodiscard]]
+        constexpr Index_t allocate() noexcept
+        {
+            Index_t node = _freeList;
+
+            if (node != npos)
+            {
+                _freeList = _nodes[node].nextSibling;
+            }
+            else
+            {
+                node = _used++;
+            }
+
+            _nodes[node] = Node{};
+            ++_size;
+
+            return node;
+        }
+
+        constexpr void release(Index_t node) noexcept
+        {
+            _nodes[node].nextSibling = _freeList;
+            _freeList = node;
+            --_size;
+        }
+
+        constexpr void assign(Index_t node, std::string_view sv) noexcept
+        {
+            for (size_t n = 0; n < sv.size(); ++n)
+            {
+                _nodes[node].s[n] = sv[n];
+            }
+
+            _nodes[node].length = static_cast<Length_t>(sv.size());
+        }
+
+        // moves the end of word / suffixes information of another node
+        constexpr void takeTerminal(Index_t node, Index_t other) noexcept
+        {
+            _nodes[node].terminalWord = _nodes[other].terminalWord;
+            _nodes[node].terminalCount = _nodes[other].terminalCount;
+            _nodes[other].terminalWord = false;
+            _nodes[other].terminalCount = 0;
+        }
+
+        constexpr void insert(std::string_view sv, bool isWord) noexcept
+        {
+            Index_t node = root;
+
+            while (!sv.empty())
+            {
+                auto child = findChild(node, sv[0]);
+
+                if (child == npos)
+                {
+                    child = allocate();
+                    assign(child, sv);
+                    _nodes[child].nextSibling = _nodes[node].firstChild;
+                    _nodes[node].firstChild = child;
+
+                    node = child;
+
+                    break;
+                }
+
+                auto label = _nodes[child].label();
+                auto endPos = commonPrefix(label, sv);
+
+                if (endPos < label.size())
+                {
+                    // the child keeps the prefix, a new node takes the rest
+                    auto child2 = allocate();
+
+                    assign(child2, label.substr(endPos));
+                    takeTerminal(child2, child);
+                    _nodes[child2].firstChild = _nodes[child].firstChild;
+                    _nodes[child].firstChild = child2;
+                    _nodes[child].length = static_cast<Length_t>(endPos);
+                }
+
+                sv.remove_prefix(endPos);
+                node = child;
+            }
+
+            if (isWord)
+            {
+                // node is considered as end of word now
+                _nodes[node].terminalWord = true;
+                ++_wordCount;
+            }
+
+            ++_nodes[node].terminalCount;
+        }
+
+        constexpr void erase(std::string_view sv, bool isWord) noexcept
+        {
+            // parents[n] is the parent of path[n]
+            Index_t path[MaxWordLength + 1] = {};
+            Index_t parents[MaxWordLength + 1] = {};
+            size_t depth = 0;
+            Index_t node = root;
+
+            while (!sv.empty())
+            {
+                auto child = findChild(node, sv[0]);
+
+                parents[depth] = node;
+                path[depth++] = child;
+                sv.remove_prefix(_nodes[child].length);
+                node = child;
+            }
+
+            if (isWord)
+            {
+                // node is no more considered as end of word
+                _nodes[node].terminalWord = false;
+                --_wordCount;
+            }
+
+            --_nodes[node].terminalCount;
+
+            while (depth-- > 0)
+            {
+                auto child = path[depth];
+                auto parent = parents[depth];
+
+                if (_nodes[child].terminalCount)
+                {
+                    continue;
+                }
+
+                auto grandChild = _nodes[child].firstChild;
+
+                if (grandChild == npos)
+                {
+                    unlink(parent, child);
+                    release(child);
+                }
+                else if (_nodes[grandChild].nextSibling == npos)
+                {
+                    // merges the child with its single child
+                    auto label = _nodes[grandChild].label();
+
+                    for (size_t n = 0; n < label.size(); ++n)
+                    {
+                        _nodes[child].s[_nodes[child].length + n] = label[n];
+                    }
+
+                    _nodes[child].length += static_cast<Length_t>(label.size());
+                    takeTerminal(child, grandChild);
+                    _nodes[child].firstChild = _nodes[grandChild].firstChild;
+                    release(grandChild);
+                }
+            }
+        }
+
+        constexpr void unlink(Index_t parent, Index_t child) noexcept
+        {
+            if (_nodes[parent].firstChild == child)
+            {
+                _nodes[parent].firstChild = _nodes[child].nextSibling;
+
+                return;
+            }
+
+            auto previous = _nodes[parent].firstChild;
+
+            while (_nodes[previous].nextSibling != child)
+            {
+                previous = _nodes[previous].nextSibling;
+            }
+
+            _nodes[previous].nextSibling = _nodes[child].nextSibling;
+        }
+
+        [[nodiscard]]
+        constexpr bool deepEqual(Index_t node,
+                                 const SmallSuffixTree& other,
+                                 Index_t nodeOther) const noexcept
+        {
+            const auto& lhs = _nodes[node];
+            const auto& rhs = other._nodes[nodeOther];
+
+            if (lhs.label() != rhs.label()
+                || lhs.terminalWord != rhs.terminalWord
+                || lhs.terminalCount != rhs.terminalCount)
+            {
+                return false;
+            }
+
+            size_t childCount = 0;
+            size_t childCountOther = 0;
+
+            for (auto child = lhs.firstChild; child != npos;
+                 child = _nodes[child].nextSibling)
+            {
+                auto childOther = other.findChild(nodeOther, _nodes[child].s[0]);
+
+                if (childOther == npos || !deepEqual(child, other, childOther))
+                {
+                    return false;
+                }
+
+                ++childCount;
+            }
+
+            for (auto child = rhs.firstChild; child != npos;
+                 child = other._nodes[child].nextSibling)
+            {
+                ++childCountOther;
+            }
+
+            return childCount == childCountOther;
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,190 @@
+#ifndef SUFFIX_AUTOMATON_HPP_
+# define SUFFIX_AUTOMATON_HPP_
+
+# include <vector>
+# include <string_view>
+# include <cstdint>
+# include <cstddef>
+
+namespace container
+{
+    /* smallest automaton recognizing the substrings of a text, built online
+       in linear time. Each state is a set of substrings ending at the same
+       positions, its length being the longest of them and its link leading
+       to the state of its longest suffix out of the set */
+    class SuffixAutomaton
+    {
+    public :
+        using State_t = std::uint32_t;
+
+        static constexpr State_t root = 0;
+        static constexpr State_t npos = static_cast<State_t>(-1);
+
+        SuffixAutomaton() :
+            _states(1)
+        { }
+
+        explicit SuffixAutomaton(std::string_view text) :
+            SuffixAutomaton()
+        {
+            _states.reserve(2 * text.size() + 1);
+            _edges.reserve(3 * text.size());
+
+            for (char c : text)
+            {
+                extend(c);
+            }
+        }
+
+        // appends a character to the text
+        void extend(char c)
+        {
+            auto state = static_cast<State_t>(_states.size());
+            auto p = _last;
+
+            _states.push_back({_states[_last].length + 1, npos, _states[_last].length, noEdge});
+            _last = state;
+
+            for (; p != npos && next(p, c) == npos; p = _states[p].link)
+            {
+                addEdge(p, c, state);
+            }
+
+            if (p == npos)
+            {
+                _states[state].link = root;
+
+                return;
+            }
+
+            auto q = next(p, c);
+
+            if (_states[p].length + 1 == _states[q].length)
+            {
+                _states[state].link = q;
+
+                return;
+            }
+
+            // q also holds longer strings, the shorter ones move to a clone
+            auto clone = static_cast<State_t>(_states.size());
+
+            _states.push_back({_states[p].length + 1, _states[q].link,
+                               _states[q].firstEnd, noEdge});
+
+            for (auto edge = _states[q].firstEdge; edge != noEdge; edge = _edges[edge].next)
+            {
+                addEdge(clone, _edges[edge].c, _edges[edge].target);
+            }
+
+            for (; p != npos; p = _states[p].link)
+            {
+                auto transition = transitionTo(p, c);
+
+                if (*transition != q)
+                {
+                    break;
+                }
+
+                *transition = clone;
+            }
+
+            _states[q].link = clone;
+            _states[state].link = clone;
+        }
+
+        [[nodiscard]]
+        inline size_t size() const noexcept { return _states.size(); }
+
+        // length of the text
+        [[nodiscard]]
+        inline size_t textLength() const noexcept { return _states[_last].length; }
+
+        // state reached from state by reading c, npos if there is none
+        [[nodiscard]]
+        State_t next(State_t state, char c) const noexcept
+        {
+            for (auto edge = _states[state].firstEdge; edge != noEdge; edge = _edges[edge].next)
+            {
+                if (_edges[edge].c == c)
+                {
+                    return _edges[edge].target;
+                }
+            }
+
+            return npos;
+        }
+
+        [[nodiscard]]
+        inline size_t length(State_t state) const noexcept { return _states[state].length; }
+
+        [[nodiscard]]
+        inline State_t link(State_t state) const noexcept { return _states[state].link; }
+
+        // position of the last character of the first occurrence of the state
+        [[nodiscard]]
+        inline size_t firstEnd(State_t state) const noexcept { return _states[state].firstEnd; }
+
+        [[nodiscard]]
+        bool contains(std::string_view s) const noexcept
+        {
+            State_t state = root;
+
+            for (char c : s)
+            {
+                state = next(state, c);
+
+                if (state == npos)
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+    private :
+        static constexpr std::uint32_t noEdge = static_cast<std::uint32_t>(-1);
+
+        struct State
+        {
+            std::uint32_t length = 0;
+            State_t link = npos;
+            std::uint32_t firstEnd = 0;
+            std::uint32_t firstEdge = noEdge;
+        };
+
+        // transitions of all states in one array, each one linked to the next of its state
+        struct Edge
+        {
+            char c;
+            State_t target;
+            std::uint32_t next;
+        };
+
+        std::vector<State> _states;
+        std::vector<Edge> _edges;
+        State_t _last = root;
+
+        void addEdge(State_t state, char c, State_t target)
+        {
+            _edges.push_back({c, target, _states[state].firstEdge});
+            _states[state].firstEdge = static_cast<std::uint32_t>(_edges.size() - 1);
+        }
+
+        // the transition must exist
+        State_t* transitionTo(State_t state, char c) noexcept
+        {
+            auto edge = _states[state].firstEdge;
+
+            while (_edges[edge].c != c)
+            {
+                edge = _edges[edge].next;
+            }
+
+            return &_edges[edge].target;
+        }
+    };
+}
+
+#endif
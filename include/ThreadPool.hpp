@@ -0,0 +1,242 @@
+#ifndef THREAD_POOL_HPP_
+# define THREAD_POOL_HPP_
+
+# include <deque>
+# include <vector>
+# include <thread>
+# include <mutex>
+# include <condition_variable>
+# include <future>
+# include <functional>
+# include <memory>
+# include <atomic>
+# include <type_traits>
+# include <chrono>
+# include <algorithm>
+
+namespace container
+{
+    /* fixed size pool where each worker owns a queue of tasks : a worker
+       takes its newest task first and steals the oldest task of another
+       worker when its own queue is empty */
+    class ThreadPool
+    {
+    public :
+        explicit ThreadPool(
+            size_t threadCount = std::max(1u, std::thread::hardware_concurrency()))
+        {
+            threadCount = std::max<size_t>(threadCount, 1);
+            _queues.reserve(threadCount);
+
+            for (size_t n = 0; n < threadCount; ++n)
+            {
+                _queues.push_back(std::make_unique<Queue>());
+            }
+
+            _workers.reserve(threadCount);
+
+            for (size_t n = 0; n < threadCount; ++n)
+            {
+                _workers.emplace_back([this, n] { work(n); });
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        ~ThreadPool()
+        {
+            {
+                std::lock_guard lock(_mutex);
+
+                _stop = true;
+            }
+
+            _condition.notify_all();
+
+            for (auto& worker : _workers)
+            {
+                worker.join();
+            }
+        }
+
+        [[nodiscard]]
+        inline size_t size() const noexcept { return _workers.size(); }
+
+        template <typename F>
+        [[nodiscard]]
+        auto submit(F&& f) -> std::future<std::invoke_result_t<std::decay_t<F>>>
+        {
+            using Result_t = std::invoke_result_t<std::decay_t<F>>;
+
+            auto task = std::make_shared<std::packaged_task<Result_t()>>(
+                std::forward<F>(f));
+            auto future = task->get_future();
+
+            // tasks submitted by a worker go to its own queue
+            size_t index = (_workerIndex != npos && _workerPool == this) ?
+                _workerIndex : _next.fetch_add(1, std::memory_order_relaxed)
+                % _queues.size();
+
+            {
+                std::lock_guard lock(_queues[index]->mutex);
+
+                _queues[index]->tasks.emplace_back([task] { (*task)(); });
+            }
+
+            {
+                std::lock_guard lock(_mutex);
+
+                ++_pending;
+            }
+
+            _condition.notify_one();
+
+            return future;
+        }
+
+        /* waits for the futures while running pending tasks, so it can be
+           called from a task without starving the pool */
+        template <typename Future>
+        void wait(std::vector<Future>& futures)
+        {
+            for (auto& future : futures)
+            {
+                while (future.wait_for(std::chrono::seconds(0))
+                       != std::future_status::ready)
+                {
+                    if (!runPendingTask())
+                    {
+                        future.wait_for(std::chrono::microseconds(50));
+                    }
+                }
+            }
+
+            for (auto& future : futures)
+            {
+                future.get();
+            }
+        }
+
+    private :
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        std::vector<std::unique_ptr<Queue>> _queues;
+        std::vector<std::thread> _workers;
+        std::atomic<size_t> _next = 0;
+        std::mutex _mutex;
+        std::condition_variable _condition;
+        size_t _pending = 0;
+        bool _stop = false;
+
+        static inline thread_local size_t _workerIndex = npos;
+        static inline thread_local const ThreadPool* _workerPool = nullptr;
+
+        [[nodiscard]]
+        bool pop(size_t index, std::function<void()>& task)
+        {
+            // own queue from the back
+            if (index < _queues.size())
+            {
+                std::lock_guard lock(_queues[index]->mutex);
+
+                if (!_queues[index]->tasks.empty())
+                {
+                    task = std::move(_queues[index]->tasks.back());
+                    _queues[index]->tasks.pop_back();
+
+                    return true;
+                }
+            }
+
+            // steal from the front of others
+            for (size_t n = 0; n < _queues.size(); ++n)
+            {
+                if (n == index)
+                {
+                    continue;
+                }
+
+                std::lock_guard lock(_queues[n]->mutex);
+
+                if (!_queues[n]->tasks.empty())
+                {
+                    task = std::move(_queues[n]->tasks.front());
+                    _queues[n]->tasks.pop_front();
+
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        [[nodiscard]]
+        bool take(size_t index, std::function<void()>& task)
+        {
+            {
+                std::lock_guard lock(_mutex);
+
+                if (!_pending)
+                {
+                    return false;
+                }
+
+                --_pending;
+            }
+
+            // a pending count always matches a queued task
+            while (!pop(index, task))
+            {
+                std::this_thread::yield();
+            }
+
+            return true;
+        }
+
+        bool runPendingTask()
+        {
+            std::function<void()> task;
+            size_t index = (_workerPool == this) ? _workerIndex : npos;
+
+            if (!take(index, task))
+            {
+                return false;
+            }
+
+            task();
+
+            return true;
+        }
+
+        void work(size_t index)
+        {
+            _workerIndex = index;
+            _workerPool = this;
+
+            for (;;)
+            {
+                {
+                    std::unique_lock lock(_mutex);
+
+                    _condition.wait(lock, [this] { return _stop || _pending; });
+
+                    if (!_pending)
+                    {
+                        return;
+                    }
+                }
+
+                runPendingTask();
+            }
+        }
+    };
+}
+
+#endif
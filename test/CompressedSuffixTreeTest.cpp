@@ -2,6 +2,14 @@
 
 #include <gtest/gtest.h>
 
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <memory_resource>
+#include <iterator>
+#include <type_traits>
+
 #include "CompressedSuffixTree.hpp"
 
 using namespace container;
@@ -33,17 +41,8 @@ TEST(CompressedSuffixTree, Test_1)
     ASSERT_EQ(tree.size(), 0);
     ASSERT_EQ(tree.wordCount(), 0);
 
-    auto root = tree.root().lock();
-
-    if (!root)
-    {
-        FAIL() << "expected root to exist";
-    }
-
-    EXPECT_TRUE(root->s.empty());
-    EXPECT_FALSE(root->terminalWord);
-    EXPECT_EQ(root->terminalCount, 0);
-    EXPECT_TRUE(root->childNodes.empty());
+    // the root is only allocated by the first insertion
+    EXPECT_TRUE(tree.root().expired());
 
     // checks with empty string
     EXPECT_FALSE(tree.insert(""));
@@ -170,17 +169,8 @@ TEST(CompressedSuffixTree, Test_1)
     ASSERT_EQ(tree.size(), 0);
     ASSERT_EQ(tree.wordCount(), 0);
 
-    root = tree.root().lock();
-
-    if (!root)
-    {
-        FAIL() << "expected root to exist";
-    }
-
-    EXPECT_TRUE(root->s.empty());
-    EXPECT_FALSE(root->terminalWord);
-    EXPECT_EQ(root->terminalCount, 0);
-    EXPECT_TRUE(root->childNodes.empty());
+    // moving doesn't allocate a new root
+    EXPECT_TRUE(tree.root().expired());
     EXPECT_NE(tree, tree3);
 
     ASSERT_FALSE(tree3.empty());
@@ -206,17 +196,9 @@ TEST(CompressedSuffixTree, Test_1)
     ASSERT_EQ(tree2.size(), 0);
     ASSERT_EQ(tree2.wordCount(), 0);
 
-    root2 = tree.root().lock();
-
-    if (!root)
-    {
-        FAIL() << "expected root to exist";
-    }
-
-    EXPECT_TRUE(root2->s.empty());
-    EXPECT_FALSE(root2->terminalWord);
-    EXPECT_EQ(root2->terminalCount, 0);
-    EXPECT_TRUE(root2->childNodes.empty());
+    // clearing releases the root
+    EXPECT_TRUE(tree2.root().expired());
+    EXPECT_EQ(tree2, tree);
 
     EXPECT_TRUE(tree3.erase("a"));
 
@@ -491,17 +473,8 @@ TEST(CompressedSuffixTree, Test_2)
     ASSERT_EQ(tree3.size(), 0);
     ASSERT_EQ(tree3.wordCount(), 0);
 
-    auto root3 = tree3.root().lock();
-
-    if (!root3)
-    {
-        FAIL() << "expected root3 to exist";
-    }
-
-    EXPECT_TRUE(root3->s.empty());
-    EXPECT_FALSE(root3->terminalWord);
-    EXPECT_EQ(root3->terminalCount, 0);
-    EXPECT_TRUE(root3->childNodes.empty());
+    EXPECT_TRUE(tree3.root().expired());
+    EXPECT_EQ(tree3, tree);
 
     tree3 = tree2;
 
@@ -509,7 +482,7 @@ TEST(CompressedSuffixTree, Test_2)
     ASSERT_EQ(tree3.size(), 12);
     ASSERT_EQ(tree3.wordCount(), 4);
 
-    root3 = tree3.root().lock();
+    auto root3 = tree3.root().lock();
 
     if (!root3)
     {
@@ -531,17 +504,7 @@ TEST(CompressedSuffixTree, Test_2)
     ASSERT_EQ(tree3.size(), 0);
     ASSERT_EQ(tree3.wordCount(), 0);
 
-    root3 = tree3.root().lock();
-
-    if (!root3)
-    {
-        FAIL() << "expected root3 to exist";
-    }
-
-    EXPECT_TRUE(root3->s.empty());
-    EXPECT_FALSE(root3->terminalWord);
-    EXPECT_EQ(root3->terminalCount, 0);
-    EXPECT_TRUE(root3->childNodes.empty());
+    EXPECT_TRUE(tree3.root().expired());
 
     ASSERT_FALSE(tree4.empty());
     ASSERT_EQ(tree4.size(), 12);
@@ -755,6 +718,621 @@ TEST(CompressedSuffixTree, Test_2)
     EXPECT_FALSE(tree4.erase("c"));
 }
 
+TEST(CompressedSuffixTree, Test_3)
+{
+    CompressedSuffixTree<std::allocator, int> tree;
+
+    EXPECT_TRUE(tree.insert("abc", 1));
+    EXPECT_TRUE(tree.insert("bc", 2));
+    EXPECT_TRUE(tree.insert("b"));
+
+    ASSERT_EQ(tree.size(), 4);
+    ASSERT_EQ(tree.wordCount(), 3);
+
+    // "bc" was a suffix of "abc" before being stored as a word
+    auto value = tree.find("bc");
+
+    ASSERT_TRUE(value);
+    EXPECT_EQ(value->get(), 2);
+    EXPECT_EQ(tree.find("abc")->get(), 1);
+    EXPECT_EQ(tree.find("b")->get(), 0);
+    EXPECT_FALSE(tree.find("c"));
+    EXPECT_FALSE(tree.find("ab"));
+    EXPECT_FALSE(tree.find(""));
+
+    EXPECT_EQ(tree.frequency("abc"), 1);
+    EXPECT_EQ(tree.frequency("c"), 0);
+
+    // duplicate insertions are counted and don't overwrite the value
+    EXPECT_FALSE(tree.insert("abc", 10));
+    EXPECT_FALSE(tree.insert("abc"));
+    EXPECT_EQ(tree.frequency("abc"), 3);
+    EXPECT_EQ(tree.find("abc")->get(), 1);
+    ASSERT_EQ(tree.wordCount(), 3);
+
+    tree.find("abc")->get() = 5;
+
+    EXPECT_EQ(tree.find("abc")->get(), 5);
+
+    // splitting the "abc" edge keeps the value on the word node
+    EXPECT_TRUE(tree.insert("ab", 7));
+    EXPECT_EQ(tree.find("abc")->get(), 5);
+    EXPECT_EQ(tree.find("ab")->get(), 7);
+    EXPECT_EQ(tree.frequency("abc"), 3);
+
+    const auto tree2 = tree;
+
+    EXPECT_EQ(tree2, tree);
+    EXPECT_EQ(tree2.find("ab")->get(), 7);
+
+    // frequencies don't take part in the comparison, values do
+    EXPECT_FALSE(tree.insert("b"));
+    EXPECT_EQ(tree2, tree);
+
+    tree.find("ab")->get() = 8;
+
+    EXPECT_NE(tree2, tree);
+
+    // merging "ab" edge back keeps the value of the remaining word
+    EXPECT_TRUE(tree.erase("ab"));
+    EXPECT_FALSE(tree.find("ab"));
+    EXPECT_EQ(tree.frequency("ab"), 0);
+    EXPECT_EQ(tree.find("abc")->get(), 5);
+    EXPECT_EQ(tree.frequency("abc"), 3);
+
+    EXPECT_TRUE(tree.erase("abc"));
+    EXPECT_FALSE(tree.find("abc"));
+    EXPECT_EQ(tree.find("bc")->get(), 2);
+
+    // a word stored again starts over
+    EXPECT_TRUE(tree.insert("abc"));
+    EXPECT_EQ(tree.find("abc")->get(), 0);
+    EXPECT_EQ(tree.frequency("abc"), 1);
+
+    CompressedSuffixTree tree3 = {"a", "a", "ba"};
+
+    ASSERT_EQ(tree3.wordCount(), 2);
+    EXPECT_EQ(tree3.frequency("a"), 2);
+    EXPECT_EQ(tree3.frequency("ba"), 1);
+    EXPECT_EQ(tree3.frequency("b"), 0);
+}
+
+TEST(CompressedSuffixTree, Test_4)
+{
+    CompressedSuffixTree tree = {"abab", "bab", "cabx"};
+
+    using Substrings = std::vector<std::pair<std::string, size_t>>;
+
+    // "a" is always followed by "b" so only "ab" is reported
+    EXPECT_EQ(tree.frequentSubstrings(3),
+              (Substrings{{"b", 5}, {"ab", 4}, {"bab", 2}}));
+    EXPECT_EQ(tree.frequentSubstrings(4, 2),
+              (Substrings{{"ab", 4}, {"bab", 2}, {"abab", 1}, {"abx", 1}}));
+    EXPECT_EQ(tree.frequentSubstrings(2, 5), Substrings{});
+    EXPECT_EQ(tree.frequentSubstrings(0), Substrings{});
+    EXPECT_EQ(tree.frequentSubstrings(100).size(), 8);
+
+    EXPECT_EQ(tree.maximalRepeats(),
+              (Substrings{{"ab", 4}, {"b", 5}, {"bab", 2}}));
+    EXPECT_EQ(tree.maximalRepeats(3), (Substrings{{"bab", 2}}));
+
+    EXPECT_TRUE(tree.erase("bab"));
+
+    // every "b" is now preceded by "a"
+    EXPECT_EQ(tree.maximalRepeats(), (Substrings{{"ab", 3}}));
+
+    EXPECT_TRUE(tree.erase("abab"));
+
+    EXPECT_EQ(tree.maximalRepeats(), Substrings{});
+    EXPECT_EQ(CompressedSuffixTree{}.maximalRepeats(), Substrings{});
+}
+
+TEST(CompressedSuffixTree, Test_5)
+{
+    CompressedSuffixTree tree = {"abde", "abc", "b", "xyz"};
+    CompressedSuffixTree tree2 = {"abd", "b", "bcd", "ab", "ca"};
+    const CompressedSuffixTree expected =
+        {"abde", "abc", "b", "xyz", "abd", "bcd", "ab", "ca"};
+
+    auto tree3 = tree;
+
+    // copies only unshared subtrees, tree2 is left untouched
+    tree3.merge(tree2);
+
+    ASSERT_EQ(tree3.size(), expected.size());
+    ASSERT_EQ(tree3.wordCount(), 8);
+    EXPECT_EQ(tree3, expected);
+    EXPECT_EQ(tree3.frequency("b"), 2);
+    EXPECT_EQ(tree3.frequency("ab"), 1);
+    EXPECT_EQ(tree2, (CompressedSuffixTree{"abd", "b", "bcd", "ab", "ca"}));
+
+    tree.merge(std::move(tree2));
+
+    ASSERT_EQ(tree.size(), expected.size());
+    ASSERT_EQ(tree.wordCount(), 8);
+    EXPECT_EQ(tree, expected);
+    ASSERT_TRUE(tree2.empty());
+    ASSERT_EQ(tree2.size(), 0);
+    ASSERT_EQ(tree2.wordCount(), 0);
+
+    // counts of words stored in both trees were fixed up
+    for (auto word : {"abde", "abc", "b", "xyz", "abd", "bcd", "ab", "ca"})
+    {
+        EXPECT_TRUE(tree.erase(word));
+    }
+
+    ASSERT_TRUE(tree.empty());
+    ASSERT_EQ(tree.size(), 0);
+    ASSERT_EQ(tree.wordCount(), 0);
+
+    tree.merge(CompressedSuffixTree{"abc"});
+    tree.merge(tree);
+
+    EXPECT_EQ(tree, CompressedSuffixTree{"abc"});
+
+    // merging "b" with its single child "a" keeps the children of "a"
+    CompressedSuffixTree tree6 = {"a", "b", "baba"};
+
+    EXPECT_TRUE(tree6.erase("a"));
+    EXPECT_TRUE(tree6.erase("b"));
+    EXPECT_EQ(tree6, CompressedSuffixTree{"baba"});
+    EXPECT_TRUE(tree6.erase("baba"));
+    ASSERT_TRUE(tree6.empty());
+
+    CompressedSuffixTree<std::allocator, int> tree4;
+    CompressedSuffixTree<std::allocator, int> tree5;
+
+    tree4.insert("ab", 1);
+    tree4.insert("b", 2);
+    tree5.insert("ab", 3);
+    tree5.insert("cab", 4);
+    tree4.merge(tree5);
+
+    ASSERT_EQ(tree4.wordCount(), 3);
+    EXPECT_EQ(tree4.find("ab")->get(), 1);
+    EXPECT_EQ(tree4.find("b")->get(), 2);
+    EXPECT_EQ(tree4.find("cab")->get(), 4);
+    EXPECT_EQ(tree4.frequency("ab"), 2);
+    EXPECT_TRUE(tree4.endsWith("ab"));
+}
+
+TEST(CompressedSuffixTree, Test_6)
+{
+    using Strings = std::vector<std::string>;
+
+    const CompressedSuffixTree tree = {"abde", "abc", "b", "abd", "xyz", "ab"};
+
+    EXPECT_EQ(Strings(tree.begin(), tree.end()),
+              (Strings{"ab", "abc", "abd", "abde", "b", "xyz"}));
+
+    Strings suffixes;
+
+    for (const auto& suffix : tree.suffixes())
+    {
+        suffixes.push_back(suffix);
+    }
+
+    EXPECT_EQ(suffixes,
+              (Strings{"b", "bc", "bd", "bde", "c", "d", "de", "e", "yz", "z"}));
+
+    EXPECT_EQ(*tree.lower_bound(""), "ab");
+    EXPECT_EQ(*tree.lower_bound("a"), "ab");
+    EXPECT_EQ(*tree.lower_bound("ab"), "ab");
+    EXPECT_EQ(*tree.upper_bound("ab"), "abc");
+    EXPECT_EQ(*tree.lower_bound("abca"), "abd");
+    EXPECT_EQ(*tree.lower_bound("abdd"), "abde");
+    EXPECT_EQ(*tree.upper_bound("abde"), "b");
+    EXPECT_EQ(*tree.lower_bound("ac"), "b");
+    EXPECT_EQ(*tree.lower_bound("b"), "b");
+    EXPECT_EQ(*tree.lower_bound("ba"), "xyz");
+    EXPECT_EQ(*tree.lower_bound("xy"), "xyz");
+    EXPECT_EQ(tree.lower_bound("xyza"), tree.end());
+    EXPECT_EQ(tree.lower_bound("y"), tree.end());
+    EXPECT_EQ(tree.upper_bound("xyz"), tree.end());
+
+    auto range = tree.range("abd", "x");
+
+    EXPECT_EQ(Strings(range.begin(), range.end()), (Strings{"abd", "abde", "b"}));
+
+    range = tree.range("abcd", "abde");
+
+    EXPECT_EQ(Strings(range.begin(), range.end()), (Strings{"abd"}));
+
+    range = tree.range("b", "b");
+
+    EXPECT_EQ(range.begin(), range.end());
+
+    auto it = tree.lower_bound("abd");
+
+    EXPECT_EQ(it.frequency(), 1);
+    EXPECT_EQ(*it++, "abd");
+    EXPECT_EQ(*it, "abde");
+    EXPECT_EQ(it->size(), 4);
+
+    EXPECT_EQ(CompressedSuffixTree{}.begin(), CompressedSuffixTree{}.end());
+
+    CompressedSuffixTree<std::allocator, int> tree2;
+
+    tree2.insert("\xff", 1);
+    tree2.insert("a", 2);
+
+    auto it2 = tree2.begin();
+
+    EXPECT_EQ(*it2, "a");
+    EXPECT_EQ(it2.value(), 2);
+    EXPECT_EQ((++it2).value(), 1);
+}
+
+TEST(CompressedSuffixTree, Test_7)
+{
+    static_assert(std::is_nothrow_move_constructible_v<CompressedSuffixTree<>>);
+    static_assert(std::is_nothrow_move_assignable_v<CompressedSuffixTree<>>);
+
+    // a tree without root behaves as an empty one
+    CompressedSuffixTree<std::allocator, int> tree;
+    std::stringstream ss;
+
+    EXPECT_EQ(tree.begin(), tree.end());
+    EXPECT_EQ(tree.lower_bound("a"), tree.end());
+    EXPECT_TRUE(tree.maximalRepeats().empty());
+    EXPECT_TRUE(tree.frequentSubstrings(3).empty());
+    EXPECT_EQ(tree.frequency("a"), 0);
+    EXPECT_FALSE(tree.find("a"));
+    EXPECT_FALSE(tree.erase("a"));
+
+    tree.save(ss);
+
+    ASSERT_TRUE(tree.load(ss));
+    EXPECT_TRUE(tree.empty());
+
+    CompressedSuffixTree<std::allocator, int> tree2 = {"ab"};
+
+    tree.merge(tree2);
+
+    EXPECT_EQ(tree, tree2);
+
+    tree2.clear();
+    tree.merge(std::move(tree2));
+
+    EXPECT_TRUE(tree.search("ab"));
+
+    // growing a vector moves trees instead of copying them
+    std::vector<CompressedSuffixTree<>> trees;
+    std::vector<std::shared_ptr<const void>> roots;
+
+    for (size_t n = 0; n < 32; ++n)
+    {
+        trees.push_back({std::to_string(n)});
+        roots.push_back(trees.back().root().lock());
+    }
+
+    for (size_t n = 0; n < trees.size(); ++n)
+    {
+        EXPECT_EQ(trees[n].root().lock(), roots[n]);
+        EXPECT_TRUE(trees[n].search(std::to_string(n)));
+    }
+}
+
+TEST(CompressedSuffixTree, Test_8)
+{
+    using instrumentation::Operation;
+
+    CompressedSuffixTree<std::allocator, void, instrumentation::Counting> tree;
+    const auto& stats = tree.instrumentation();
+
+    // root and the nodes of "abc", "bc" and "c"
+    ASSERT_TRUE(tree.insert("abc"));
+    EXPECT_EQ(stats.count(Operation::Insert), 1);
+    EXPECT_EQ(stats.totals(Operation::Insert).allocations, 4);
+    EXPECT_EQ(stats.totals(Operation::Insert).nodesSplit, 0);
+
+    // "abc" and "bc" are split
+    ASSERT_TRUE(tree.insert("abd"));
+    EXPECT_EQ(stats.count(Operation::Insert), 2);
+    EXPECT_EQ(stats.totals(Operation::Insert).nodesSplit, 2);
+
+    ASSERT_TRUE(tree.search("abd"));
+
+    auto search = stats.totals(Operation::Search);
+
+    EXPECT_EQ(stats.count(Operation::Search), 1);
+    EXPECT_EQ(search.nodesVisited, 2);
+    EXPECT_EQ(search.labelBytesCompared, 3);
+    EXPECT_GE(search.childEntriesScanned, 2);
+    EXPECT_EQ(search.allocations, 0);
+
+    // "ab" and "b" are merged back with their remaining child
+    ASSERT_TRUE(tree.erase("abd"));
+    EXPECT_EQ(stats.totals(Operation::Erase).nodesMerged, 2);
+
+    // nested operations are counted once
+    (void) tree.upper_bound("ab");
+    EXPECT_EQ(stats.count(Operation::Seek), 1);
+    EXPECT_EQ(stats.count(Operation::Search), 1);
+
+    size_t latencies = 0;
+
+    for (auto n : stats.latencies(Operation::Insert))
+    {
+        latencies += n;
+    }
+
+    EXPECT_EQ(latencies, 2);
+
+    tree.instrumentation().reset();
+
+    EXPECT_EQ(stats.count(Operation::Insert), 0);
+    EXPECT_EQ(stats.totals(Operation::Insert).allocations, 0);
+}
+
+TEST(CompressedSuffixTree, Test_9)
+{
+    CompressedSuffixTree tree = {"abde", "abc", "b"};
+    CompressedSuffixTree tree2 = {"b", "abc", "abde"};
+    CompressedSuffixTree tree3;
+
+    // hashes don't depend on the insertion order nor on the history
+    EXPECT_EQ(tree.fingerprint(), tree2.fingerprint());
+    EXPECT_EQ(tree3.fingerprint(), CompressedSuffixTree().fingerprint());
+    EXPECT_FALSE(tree.firstDifference(tree2));
+
+    ASSERT_TRUE(tree2.insert("abd"));
+
+    EXPECT_NE(tree.fingerprint(), tree2.fingerprint());
+    EXPECT_EQ(tree.firstDifference(tree2), "abd");
+    EXPECT_EQ(tree.fingerprint("c"), tree2.fingerprint("c"));
+    EXPECT_NE(tree.fingerprint("ab"), tree2.fingerprint("ab"));
+    EXPECT_EQ(tree.fingerprint("abd"), tree.fingerprint("abde"));
+    EXPECT_EQ(tree.fingerprint("x"), 0);
+
+    ASSERT_TRUE(tree2.erase("abd"));
+
+    EXPECT_EQ(tree.fingerprint(), tree2.fingerprint());
+
+    ASSERT_TRUE(tree3.insert("xyz"));
+
+    EXPECT_EQ(tree.firstDifference(tree3), "a");
+
+    tree3.merge(tree);
+    tree3.erase("xyz");
+
+    EXPECT_EQ(tree3.fingerprint(), tree.fingerprint());
+    EXPECT_EQ(tree3, tree);
+
+    std::stringstream ss;
+
+    tree.save(ss);
+
+    ASSERT_TRUE(tree3.load(ss));
+    EXPECT_EQ(tree3.fingerprint(), tree.fingerprint());
+}
+
+TEST(CompressedSuffixTree, Test_10)
+{
+    using Strings = std::vector<std::string>;
+
+    EXPECT_EQ(normalization::normalize<normalization::AsciiCaseFold>("AbC-1é"),
+              "abc-1é");
+    EXPECT_EQ(normalization::normalize<normalization::Utf8CaseFold>("ÉtÉ ΣΑΣ Мир"),
+              "été σασ мир");
+    EXPECT_EQ(normalization::normalize<normalization::Utf8AccentFold>("Ça Œuvre Łódź"),
+              "ca œuvre lodz");
+    // invalid sequences are kept as is
+    EXPECT_EQ(normalization::normalize<normalization::Utf8AccentFold>("A\xC3"),
+              "a\xC3");
+
+    CompressedSuffixTree<std::allocator, int, instrumentation::None,
+                         normalization::AsciiCaseFold> tree;
+
+    ASSERT_TRUE(tree.insert("Hello", 1));
+    ASSERT_FALSE(tree.insert("HELLO", 2));
+    ASSERT_FALSE(tree.insert("hello"));
+    ASSERT_TRUE(tree.insert("World"));
+
+    EXPECT_TRUE(tree.search("hElLo"));
+    EXPECT_TRUE(tree.endsWith("LLO"));
+    EXPECT_FALSE(tree.endsWith("hello"));
+    EXPECT_EQ(tree.frequency("HELLO"), 3);
+    EXPECT_EQ(tree.find("hello")->get(), 1);
+    EXPECT_EQ(tree.originals("HeLLo"), (Strings{"hello", "Hello", "HELLO"}));
+    EXPECT_TRUE(tree.originals("xyz").empty());
+    EXPECT_EQ(Strings(tree.begin(), tree.end()), (Strings{"hello", "world"}));
+    EXPECT_EQ(*tree.lower_bound("WO"), "world");
+
+    auto tree2 = tree;
+    std::stringstream ss;
+
+    tree2.save(ss);
+    tree2.clear();
+
+    ASSERT_TRUE(tree2.load(ss));
+    EXPECT_EQ(tree2.originals("hello"), tree.originals("hello"));
+
+    ASSERT_TRUE(tree.erase("HELLO"));
+    EXPECT_FALSE(tree.search("hello"));
+    EXPECT_TRUE(tree.originals("hello").empty());
+
+    CompressedSuffixTree<std::allocator, void, instrumentation::None,
+                         normalization::Utf8AccentFold> tree3 = {"Café", "Élan"};
+
+    EXPECT_TRUE(tree3.search("CAFE"));
+    EXPECT_TRUE(tree3.search("elan"));
+    EXPECT_TRUE(tree3.endsWith("fÉ"));
+    EXPECT_TRUE(tree3.endsWith("LAN"));
+    EXPECT_EQ(tree3.originals("cafe"), (Strings{"Café"}));
+
+    tree3.merge(decltype(tree3){"CAFÉ"});
+
+    EXPECT_EQ(tree3.originals("cafe"), (Strings{"Café", "CAFÉ"}));
+}
+
+TEST(CompressedSuffixTree, Test_11)
+{
+    // leaves don't allocate a map of children
+    CompressedSuffixTree tree = {"abc", "abd"};
+    auto root = tree.root().lock();
+
+    ASSERT_TRUE(root);
+    EXPECT_EQ(sizeof(root->childNodes), sizeof(void*));
+    EXPECT_EQ(root->childNodes.size(), 4);
+
+    size_t leaves = 0;
+
+    for (const auto& [sv, childNode] : root->childNodes)
+    {
+        EXPECT_EQ(sv, childNode->s);
+
+        if (childNode->childNodes.empty())
+        {
+            EXPECT_EQ(childNode->childNodes.size(), 0);
+            EXPECT_EQ(childNode->childNodes.begin(), childNode->childNodes.end());
+            ++leaves;
+        }
+    }
+
+    EXPECT_EQ(leaves, 2);
+
+    // the map of a node is released with its last child
+    ASSERT_TRUE(tree.erase("abd"));
+    ASSERT_TRUE(tree.erase("abc"));
+    EXPECT_TRUE(root->childNodes.empty());
+    EXPECT_EQ(root->childNodes.find("a"), root->childNodes.cend());
+
+    tree.insert("abc");
+
+    EXPECT_TRUE(tree.search("abc"));
+    EXPECT_TRUE(tree.endsWith("bc"));
+    EXPECT_EQ(tree.size(), 3);
+}
+
+namespace
+{
+    // counts the bytes still allocated through it
+    class CountingResource : public std::pmr::memory_resource
+    {
+    public :
+        size_t allocated = 0;
+
+    private :
+        void* do_allocate(size_t bytes, size_t alignment) override
+        {
+            allocated += bytes;
+
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override
+        {
+            allocated -= bytes;
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+    };
+
+    // fails every allocation left to the default resource while in scope
+    struct NoDefaultResource
+    {
+        std::pmr::memory_resource* previous =
+            std::pmr::set_default_resource(std::pmr::null_memory_resource());
+
+        ~NoDefaultResource()
+        {
+            std::pmr::set_default_resource(previous);
+        }
+    };
+}
+
+TEST(CompressedSuffixTree, Test_12)
+{
+    using Tree_t = CompressedSuffixTree<std::pmr::polymorphic_allocator>;
+
+    static_assert(std::is_nothrow_move_constructible_v<Tree_t>);
+    static_assert(!std::is_nothrow_move_assignable_v<Tree_t>);
+
+    CountingResource resource;
+    CountingResource resource2;
+
+    {
+        NoDefaultResource guard;
+        Tree_t tree(&resource);
+
+        // nodes, labels and child maps are all allocated by the resource
+        EXPECT_TRUE(tree.insert("banana"));
+        EXPECT_TRUE(tree.insert("bandana"));
+        EXPECT_TRUE(tree.insert("ananas"));
+        EXPECT_GT(resource.allocated, 0);
+        EXPECT_TRUE(tree.search("bandana"));
+        EXPECT_TRUE(tree.endsWith("nas"));
+        EXPECT_TRUE(tree.erase("banana"));
+        EXPECT_FALSE(tree.search("banana"));
+        EXPECT_TRUE(tree.endsWith("dana"));
+
+        std::stringstream ss;
+
+        tree.save(ss);
+
+        Tree_t loaded(&resource2);
+
+        EXPECT_TRUE(loaded.load(ss));
+        EXPECT_EQ(loaded, tree);
+
+        // the copy is made with the given allocator
+        Tree_t copy(tree, &resource2);
+
+        EXPECT_EQ(copy, tree);
+        EXPECT_EQ(copy.get_allocator().resource(), &resource2);
+
+        // nodes are copied between different resources, moved otherwise
+        auto allocated = resource.allocated;
+
+        copy.merge(Tree_t{{"nab"}, &resource});
+        EXPECT_TRUE(copy.search("nab"));
+        EXPECT_EQ(resource.allocated, allocated);
+
+        loaded = std::move(copy);
+        EXPECT_TRUE(copy.empty());
+        EXPECT_TRUE(loaded.search("nab"));
+
+        Tree_t moved(std::move(tree));
+
+        EXPECT_TRUE(moved.search("ananas"));
+        EXPECT_EQ(moved.get_allocator().resource(), &resource);
+
+        moved.clear();
+        EXPECT_EQ(resource.allocated, 0);
+    }
+
+    EXPECT_EQ(resource2.allocated, 0);
+
+    // short lived trees without any release of node
+    std::pmr::monotonic_buffer_resource buffer;
+    Tree_t tree({"abc", "bcd", "cde"}, &buffer);
+
+    EXPECT_TRUE(tree.endsWith("de"));
+    EXPECT_EQ(std::distance(tree.begin(), tree.end()), 3);
+
+    // the spellings of a word stay in the resource when its node is split
+    CompressedSuffixTree<std::pmr::polymorphic_allocator, void, instrumentation::None,
+                         normalization::AsciiCaseFold> folded(&resource);
+
+    {
+        NoDefaultResource guard;
+
+        folded.insert("Banana");
+        folded.insert("Ban");
+        folded.insert("BAN");
+        EXPECT_TRUE(folded.search("bAn"));
+        EXPECT_EQ(folded.originals("ban"), (std::vector<std::string>{"Ban", "BAN"}));
+    }
+
+    folded.clear();
+    EXPECT_EQ(resource.allocated, 0);
+}
+
 int main(int argc, char **argv)
 {
     testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+
+#include "DurableSuffixTree.hpp"
+
+using namespace container;
+
+namespace
+{
+    std::filesystem::path makeDirectory(const std::string& name)
+    {
+        auto path = std::filesystem::temp_directory_path()
+            / ("DurableSuffixTreeTest_" + name + "_" + std::to_string(::getpid()));
+
+        std::filesystem::remove_all(path);
+
+        return path;
+    }
+}
+
+TEST(CompressedSuffixTree, SaveLoad)
+{
+    CompressedSuffixTree<std::allocator, int> tree;
+
+    tree.insert("abde", 1);
+    tree.insert("abc", 2);
+    tree.insert("b", 3);
+    tree.insert("b");
+
+    std::stringstream ss;
+
+    tree.save(ss);
+
+    CompressedSuffixTree<std::allocator, int> tree2 = {"xyz"};
+
+    ASSERT_TRUE(tree2.load(ss));
+    EXPECT_EQ(tree2, tree);
+    ASSERT_EQ(tree2.size(), tree.size());
+    ASSERT_EQ(tree2.wordCount(), 3);
+    EXPECT_EQ(tree2.find("abc")->get(), 2);
+    EXPECT_EQ(tree2.frequency("b"), 2);
+    EXPECT_FALSE(tree2.search("xyz"));
+
+    // truncated snapshot
+    std::stringstream ss2;
+
+    tree.save(ss2);
+
+    auto data = ss2.str();
+    std::stringstream ss3(data.substr(0, data.size() - 3));
+
+    EXPECT_FALSE(tree2.load(ss3));
+    ASSERT_TRUE(tree2.empty());
+    ASSERT_EQ(tree2.wordCount(), 0);
+}
+
+TEST(DurableSuffixTree, Test_1)
+{
+    auto directory = makeDirectory("1");
+
+    {
+        DurableSuffixTree<> tree(directory, {4, 1, 0});
+
+        ASSERT_TRUE(tree.tree().empty());
+        EXPECT_TRUE(tree.insert("abde"));
+        EXPECT_TRUE(tree.insert("abc"));
+        EXPECT_FALSE(tree.insert("abc"));
+        EXPECT_TRUE(tree.insert("b"));
+        EXPECT_TRUE(tree.erase("b"));
+        EXPECT_FALSE(tree.erase("b"));
+        EXPECT_FALSE(tree.insert(""));
+    }
+
+    {
+        // log replay
+        DurableSuffixTree<> tree(directory);
+
+        EXPECT_EQ(tree.tree(), (CompressedSuffixTree{"abde", "abc"}));
+        EXPECT_EQ(tree.tree().frequency("abc"), 2);
+        EXPECT_EQ(tree.generation(), 0);
+
+        tree.checkpoint();
+
+        EXPECT_EQ(tree.generation(), 1);
+        EXPECT_TRUE(tree.insert("xyz"));
+        EXPECT_TRUE(tree.erase("abde"));
+        tree.sync();
+    }
+
+    // a torn record at the end of the log is dropped
+    std::ofstream(directory / "log.1", std::ios::binary | std::ios::app)
+        << "\x01\x05garb";
+
+    {
+        // snapshot + log replay
+        DurableSuffixTree<> tree(directory);
+
+        EXPECT_EQ(tree.generation(), 1);
+        EXPECT_EQ(tree.tree(), (CompressedSuffixTree{"abc", "xyz"}));
+        EXPECT_TRUE(tree.insert("q"));
+    }
+
+    {
+        DurableSuffixTree<> tree(directory);
+
+        EXPECT_EQ(tree.tree(), (CompressedSuffixTree{"abc", "xyz", "q"}));
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(DurableSuffixTree, Test_2)
+{
+    auto directory = makeDirectory("2");
+
+    {
+        // checkpoint every 3 records
+        DurableSuffixTree<CompressedSuffixTree<std::allocator, long>> tree(
+            directory, {16, 0, 3});
+
+        EXPECT_TRUE(tree.insert("abc", 1));
+        EXPECT_TRUE(tree.insert("bcd", 2));
+        EXPECT_EQ(tree.generation(), 0);
+        EXPECT_TRUE(tree.insert("cde", 3));
+        EXPECT_EQ(tree.generation(), 1);
+        EXPECT_TRUE(tree.insert("def", 4));
+        EXPECT_FALSE(tree.insert("abc", 5));
+        EXPECT_TRUE(tree.insert("efg"));
+        EXPECT_TRUE(tree.erase("efg"));
+        EXPECT_TRUE(tree.insert("fgh"));
+    }
+
+    {
+        DurableSuffixTree<CompressedSuffixTree<std::allocator, long>> tree(directory);
+
+        EXPECT_EQ(tree.generation(), 2);
+        ASSERT_EQ(tree.tree().wordCount(), 5);
+        EXPECT_EQ(tree.tree().find("fgh")->get(), 0);
+        EXPECT_FALSE(tree.search("efg"));
+        EXPECT_EQ(tree.tree().find("abc")->get(), 1);
+        EXPECT_EQ(tree.tree().find("def")->get(), 4);
+        EXPECT_EQ(tree.tree().frequency("abc"), 2);
+        EXPECT_TRUE(tree.endsWith("ef"));
+        EXPECT_TRUE(tree.search("cde"));
+    }
+
+    EXPECT_FALSE(std::filesystem::exists(directory / "log.0"));
+
+    std::filesystem::remove_all(directory);
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
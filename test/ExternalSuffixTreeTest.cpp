@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "ExternalSuffixTree.hpp"
+
+using namespace container;
+
+namespace
+{
+    std::filesystem::path makeDirectory(const std::string& name)
+    {
+        auto path = std::filesystem::temp_directory_path()
+            / ("ExternalSuffixTreeTest_" + name + "_" + std::to_string(::getpid()));
+
+        std::filesystem::remove_all(path);
+
+        return path;
+    }
+}
+
+TEST(ExternalSuffixTree, Test_1)
+{
+    auto directory = makeDirectory("Test_1");
+
+    {
+        ExternalSuffixTreeBuilder builder(directory);
+
+        EXPECT_FALSE(builder.add(""));
+
+        for (auto word : {"abde", "abc", "b", "xyz", "abc"})
+        {
+            EXPECT_TRUE(builder.add(word));
+        }
+
+        // everything fits in the default budget
+        EXPECT_EQ(builder.finish(), 1);
+    }
+
+    EXPECT_FALSE(std::filesystem::exists(directory / "words.tmp"));
+    EXPECT_FALSE(std::filesystem::exists(directory / "bucket.0.tmp"));
+
+    const ExternalSuffixTree tree(directory);
+
+    EXPECT_EQ(tree.partitionCount(), 1);
+    EXPECT_EQ(tree.wordCount(), 5);
+    EXPECT_TRUE(tree.search("abc"));
+    EXPECT_TRUE(tree.search("b"));
+    EXPECT_FALSE(tree.search("ab"));
+    EXPECT_FALSE(tree.search(""));
+    EXPECT_TRUE(tree.endsWith("bc"));
+    EXPECT_FALSE(tree.endsWith("b"));
+    EXPECT_TRUE(tree.endsWith("de"));
+    EXPECT_FALSE(tree.endsWith("abde"));
+
+    // the tree of the partition only has the path of each suffix
+    const CompressedSuffixTree reference = {"abde", "abc", "b", "xyz"};
+
+    EXPECT_EQ(tree.partition(0).size(), reference.size());
+
+    std::filesystem::remove(directory / "manifest");
+    EXPECT_THROW(ExternalSuffixTree<>{directory}, std::runtime_error);
+    std::filesystem::remove_all(directory);
+}
+
+TEST(ExternalSuffixTree, Test_2)
+{
+    // a small budget splits the suffixes in many partitions
+    auto directory = makeDirectory("Test_2");
+    std::mt19937 gen(19);
+    std::uniform_int_distribution<int> letter('a', 'd');
+    std::uniform_int_distribution<size_t> length(1, 10);
+    std::vector<std::string> words;
+    CompressedSuffixTree<> reference;
+    ExternalBuildOptions options;
+
+    options.memoryBudget = 2000;
+    options.bytesPerSuffix = 16;
+    options.maxOpenFiles = 3;
+
+    ExternalSuffixTreeBuilder builder(directory, options);
+
+    for (size_t n = 0; n < 300; ++n)
+    {
+        std::string word(length(gen), ' ');
+
+        for (auto& c : word)
+        {
+            c = static_cast<char>(letter(gen));
+        }
+
+        if (n % 2 == 0)
+        {
+            reference.insert(word);
+            builder.add(word);
+        }
+
+        words.push_back(word);
+    }
+
+    auto partitionCount = builder.finish();
+
+    EXPECT_GT(partitionCount, 10);
+
+    const ExternalSuffixTree tree(directory);
+
+    ASSERT_EQ(tree.partitionCount(), partitionCount);
+
+    for (const auto& word : words)
+    {
+        for (size_t n = 0; n < word.size(); ++n)
+        {
+            auto sv = std::string_view(word).substr(n);
+
+            ASSERT_EQ(tree.search(sv), reference.search(sv)) << sv;
+            ASSERT_EQ(tree.endsWith(sv), reference.endsWith(sv)) << sv;
+        }
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(ExternalSuffixTree, Test_3)
+{
+    // suffixes are partitioned and stored in their normalized form
+    using Tree_t = CompressedSuffixTree<std::allocator, void, instrumentation::None,
+                                        normalization::AsciiCaseFold>;
+
+    auto directory = makeDirectory("Test_3");
+    ExternalBuildOptions options;
+
+    options.memoryBudget = 100;
+    options.bytesPerSuffix = 16;
+
+    {
+        ExternalSuffixTreeBuilder<Tree_t> builder(directory, options);
+
+        for (auto word : {"Hello", "WORLD", "zebra", "Apple", "mango"})
+        {
+            EXPECT_TRUE(builder.add(word));
+        }
+
+        EXPECT_GT(builder.finish(), 2);
+    }
+
+    const ExternalSuffixTree<Tree_t> tree(directory);
+
+    EXPECT_EQ(tree.partitionOf("WoRlD"), tree.partitionOf("world"));
+    EXPECT_TRUE(tree.search("hello"));
+    EXPECT_TRUE(tree.search("HELLO"));
+    EXPECT_TRUE(tree.search("world"));
+    EXPECT_TRUE(tree.search("APPLE"));
+    EXPECT_TRUE(tree.endsWith("orld"));
+    EXPECT_TRUE(tree.endsWith("ORLD"));
+    EXPECT_TRUE(tree.endsWith("LlO"));
+    EXPECT_FALSE(tree.search("hell"));
+    EXPECT_FALSE(tree.endsWith("WORLD"));
+
+    std::filesystem::remove_all(directory);
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,345 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "FrozenSuffixTree.hpp"
+
+using namespace container;
+
+TEST(FrozenSuffixTree, Test_1)
+{
+    FrozenSuffixTree<> empty;
+
+    EXPECT_TRUE(empty.empty());
+    EXPECT_FALSE(empty.search("a"));
+    EXPECT_TRUE(FrozenSuffixTree<>(CompressedSuffixTree<>()).empty());
+
+    const CompressedSuffixTree tree = {"abde", "abc", "b", "xyz"};
+    const FrozenSuffixTree frozen(tree);
+
+    ASSERT_EQ(frozen.size(), tree.size());
+    ASSERT_EQ(frozen.wordCount(), tree.wordCount());
+
+    EXPECT_TRUE(frozen.search("abc"));
+    EXPECT_TRUE(frozen.search("b"));
+    EXPECT_FALSE(frozen.search("ab"));
+    EXPECT_FALSE(frozen.search(""));
+    EXPECT_TRUE(frozen.endsWith("bc"));
+    EXPECT_FALSE(frozen.endsWith("b"));
+    EXPECT_TRUE(frozen.endsWith("de"));
+    EXPECT_FALSE(frozen.endsWith("abde"));
+    EXPECT_FALSE(frozen.endsWith("x"));
+
+    // queries are normalized as in the source tree
+    CompressedSuffixTree<std::allocator, void, instrumentation::None,
+                         normalization::AsciiCaseFold> tree2 = {"Hello"};
+    const FrozenSuffixTree frozen2(tree2);
+
+    EXPECT_TRUE(frozen2.search("HELLO"));
+    EXPECT_TRUE(frozen2.endsWith("LO"));
+}
+
+TEST(FrozenSuffixTree, Test_2)
+{
+    // same answers as the source tree
+    std::mt19937 gen(5);
+    std::uniform_int_distribution<int> letter('a', 'd');
+    std::uniform_int_distribution<size_t> length(1, 7);
+    std::vector<std::string> words;
+    CompressedSuffixTree<> tree;
+
+    for (size_t n = 0; n < 300; ++n)
+    {
+        std::string word(length(gen), ' ');
+
+        for (auto& c : word)
+        {
+            c = static_cast<char>(letter(gen));
+        }
+
+        tree.insert(word);
+        words.push_back(word);
+    }
+
+    const FrozenSuffixTree frozen(tree);
+
+    ASSERT_EQ(frozen.size(), tree.size());
+
+    for (const auto& word : words)
+    {
+        for (size_t n = 0; n < word.size(); ++n)
+        {
+            for (size_t m = n + 1; m <= word.size(); ++m)
+            {
+                auto sv = std::string_view(word).substr(n, m - n);
+
+                ASSERT_EQ(frozen.search(sv), tree.search(sv)) << sv;
+                ASSERT_EQ(frozen.endsWith(sv), tree.endsWith(sv)) << sv;
+            }
+        }
+    }
+}
+
+TEST(FrozenSuffixTree, Test_3)
+{
+    using Views = std::vector<std::string_view>;
+
+    const FrozenSuffixTree empty(CompressedSuffixTree<>(), FreezeOptions{true});
+
+    EXPECT_TRUE(empty.hasDocuments());
+    EXPECT_EQ(empty.documentCount("a"), 0);
+    EXPECT_TRUE(empty.documents("a").empty());
+
+    // "ana" occurs twice in "banana" but is counted once
+    const CompressedSuffixTree tree = {"banana", "ananas", "bandana", "cab"};
+    const FrozenSuffixTree frozen(tree, FreezeOptions{true});
+
+    EXPECT_FALSE(FrozenSuffixTree(tree).hasDocuments());
+    EXPECT_EQ(frozen.documentCount("ana"), 3);
+    EXPECT_EQ(frozen.documentCount("an"), 3);
+    EXPECT_EQ(frozen.documentCount("a"), 4);
+    EXPECT_EQ(frozen.documentCount("nan"), 2);
+    EXPECT_EQ(frozen.documentCount("dan"), 1);
+    EXPECT_EQ(frozen.documentCount("xyz"), 0);
+    EXPECT_EQ(frozen.documentCount(""), 4);
+
+    auto documents = frozen.documents("ana");
+
+    std::sort(documents.begin(), documents.end());
+    EXPECT_EQ(documents, (Views{"ananas", "banana", "bandana"}));
+    EXPECT_EQ(frozen.documents("ca"), (Views{"cab"}));
+    EXPECT_TRUE(frozen.documents("nab").empty());
+}
+
+TEST(FrozenSuffixTree, Test_4)
+{
+    // same counts and lists as a scan of the words
+    std::mt19937 gen(13);
+    std::uniform_int_distribution<int> letter('a', 'c');
+    std::uniform_int_distribution<size_t> length(1, 9);
+    std::vector<std::string> words;
+    CompressedSuffixTree<> tree;
+
+    for (size_t n = 0; n < 200; ++n)
+    {
+        std::string word(length(gen), ' ');
+
+        for (auto& c : word)
+        {
+            c = static_cast<char>(letter(gen));
+        }
+
+        if (tree.insert(word))
+        {
+            words.push_back(word);
+        }
+    }
+
+    const FrozenSuffixTree frozen(tree, FreezeOptions{true});
+
+    for (const auto& word : words)
+    {
+        for (size_t n = 0; n < word.size(); ++n)
+        {
+            for (size_t m = n + 1; m <= word.size(); ++m)
+            {
+                auto pattern = word.substr(n, m - n);
+                std::vector<std::string> expected;
+
+                for (const auto& other : words)
+                {
+                    if (other.find(pattern) != std::string::npos)
+                    {
+                        expected.push_back(other);
+                    }
+                }
+
+                auto documents = frozen.documents(pattern);
+                std::vector<std::string> res(documents.cbegin(), documents.cend());
+
+                std::sort(expected.begin(), expected.end());
+                std::sort(res.begin(), res.end());
+
+                ASSERT_EQ(frozen.documentCount(pattern), expected.size()) << pattern;
+                ASSERT_EQ(res, expected) << pattern;
+            }
+        }
+    }
+}
+
+TEST(FrozenSuffixTree, Test_5)
+{
+    // the jump table gives the same answers as the descent from the root
+    std::mt19937 gen(31);
+    std::uniform_int_distribution<int> letter('a', 'e');
+    std::uniform_int_distribution<size_t> length(1, 7);
+    std::vector<std::string> words;
+    CompressedSuffixTree<> tree;
+
+    for (size_t n = 0; n < 300; ++n)
+    {
+        std::string word(length(gen), ' ');
+
+        for (auto& c : word)
+        {
+            c = static_cast<char>(letter(gen));
+        }
+
+        if (n % 2 == 0)
+        {
+            tree.insert(word);
+        }
+
+        words.push_back(word);
+    }
+
+    const FrozenSuffixTree reference(tree, FreezeOptions{true});
+
+    for (size_t jumpLength : {1, 2, 3})
+    {
+        const FrozenSuffixTree frozen(tree, FreezeOptions{true, jumpLength});
+
+        ASSERT_EQ(frozen.jumpLength(), jumpLength);
+        EXPECT_GT(frozen.memoryUsage(), reference.memoryUsage());
+
+        for (const auto& word : words)
+        {
+            for (size_t n = 0; n < word.size(); ++n)
+            {
+                for (size_t m = n; m <= word.size(); ++m)
+                {
+                    auto sv = std::string_view(word).substr(n, m - n);
+
+                    ASSERT_EQ(frozen.search(sv), reference.search(sv)) << sv;
+                    ASSERT_EQ(frozen.endsWith(sv), reference.endsWith(sv)) << sv;
+                    ASSERT_EQ(frozen.documentCount(sv), reference.documentCount(sv)) << sv;
+                }
+            }
+        }
+    }
+
+    EXPECT_THROW(FrozenSuffixTree(tree, FreezeOptions{false, 4}), std::length_error);
+    EXPECT_EQ(FrozenSuffixTree(CompressedSuffixTree<>(), FreezeOptions{false, 2}).jumpLength(), 0);
+
+    // queries are normalized before the lookup in the table
+    CompressedSuffixTree<std::allocator, void, instrumentation::None,
+                         normalization::AsciiCaseFold> tree2 = {"Hello"};
+    const FrozenSuffixTree frozen2(tree2, FreezeOptions{false, 2});
+
+    EXPECT_TRUE(frozen2.search("HELLO"));
+    EXPECT_TRUE(frozen2.endsWith("LO"));
+    EXPECT_TRUE(frozen2.endsWith("O"));
+    EXPECT_FALSE(frozen2.endsWith("HE"));
+}
+
+TEST(FrozenSuffixTree, Test_6)
+{
+    using Match_t = std::tuple<size_t, std::string, size_t, size_t>;
+
+    const FrozenSuffixTree empty(CompressedSuffixTree<>(), FreezeOptions{false, 0, true});
+
+    EXPECT_TRUE(empty.hasMatches());
+    EXPECT_EQ(empty.matchingStatistics("abc"), std::vector<size_t>(3, 0));
+
+    CompressedSuffixTree<> tree = {"gattaca", "tacag"};
+    const FrozenSuffixTree frozen(tree, FreezeOptions{false, 0, true});
+    std::vector<Match_t> mems;
+    std::vector<Match_t> mums;
+
+    EXPECT_TRUE(frozen.hasDocuments());
+    EXPECT_EQ(frozen.matchingStatistics("cattac"), (std::vector<size_t>{2, 5, 4, 3, 2, 1}));
+
+    frozen.maximalExactMatches("cattac", 3, [&](const ExactMatch& match)
+    {
+        mems.emplace_back(match.queryPosition, match.word, match.wordPosition, match.length);
+    });
+    frozen.maximalUniqueMatches("cattac", 3, [&](const ExactMatch& match)
+    {
+        mums.emplace_back(match.queryPosition, match.word, match.wordPosition, match.length);
+    });
+
+    // "ttac" extends to the left, "tac" occurs twice in the words
+    EXPECT_EQ(mems, (std::vector<Match_t>{{1, "gattaca", 1, 5}, {3, "tacag", 0, 3}}));
+    EXPECT_EQ(mums, (std::vector<Match_t>{{1, "gattaca", 1, 5}}));
+
+    // against every pair of positions
+    std::mt19937 gen(6);
+    std::uniform_int_distribution<int> letter('a', 'c');
+    std::vector<std::string> words(40);
+
+    for (auto& word : words)
+    {
+        for (size_t n = 0; n < 10; ++n)
+        {
+            word.push_back(static_cast<char>(letter(gen)));
+        }
+    }
+
+    CompressedSuffixTree<> tree2(words.cbegin(), words.cend());
+    const FrozenSuffixTree frozen2(tree2, FreezeOptions{false, 0, true});
+    std::string query;
+
+    for (size_t n = 0; n < 100; ++n)
+    {
+        query.push_back(static_cast<char>(letter(gen)));
+    }
+
+    std::set<Match_t> expected;
+    std::set<Match_t> res;
+
+    for (const auto& word : std::set<std::string>(words.cbegin(), words.cend()))
+    {
+        for (size_t n = 0; n < query.size(); ++n)
+        {
+            for (size_t m = 0; m < word.size(); ++m)
+            {
+                size_t length = 0;
+
+                while (n + length < query.size()
+                       && m + length < word.size()
+                       && query[n + length] == word[m + length])
+                {
+                    ++length;
+                }
+
+                if (length >= 4 && (n == 0 || m == 0 || query[n - 1] != word[m - 1]))
+                {
+                    expected.emplace(n, word, m, length);
+                }
+            }
+        }
+    }
+
+    frozen2.maximalExactMatches(query, 4, [&](const ExactMatch& match)
+    {
+        EXPECT_TRUE(res.emplace(match.queryPosition, match.word,
+                                match.wordPosition, match.length).second);
+    });
+
+    EXPECT_EQ(res, expected);
+
+    // positions are those of the normalized query
+    CompressedSuffixTree<std::allocator, void, instrumentation::None,
+                         normalization::AsciiCaseFold> tree3 = {"Hello"};
+    const FrozenSuffixTree frozen3(tree3, FreezeOptions{false, 0, true});
+
+    mums.clear();
+    frozen3.maximalUniqueMatches("sHELL", 2, [&](const ExactMatch& match)
+    {
+        mums.emplace_back(match.queryPosition, match.word, match.wordPosition, match.length);
+    });
+
+    EXPECT_EQ(mums, (std::vector<Match_t>{{1, "hello", 0, 4}}));
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
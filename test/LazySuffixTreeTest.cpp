@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "CompressedSuffixTree.hpp"
+#include "LazySuffixTree.hpp"
+
+using namespace container;
+
+TEST(LazySuffixTree, Test_1)
+{
+    LazySuffixTree empty;
+
+    EXPECT_TRUE(empty.empty());
+    EXPECT_FALSE(empty.search("a"));
+    EXPECT_FALSE(empty.insert(""));
+    EXPECT_EQ(empty.expandedNodeCount(), 0);
+
+    LazySuffixTree tree = {"abde", "abc", "b", "xyz"};
+
+    EXPECT_EQ(tree.wordCount(), 4);
+    EXPECT_EQ(tree.expandedNodeCount(), 0);
+
+    EXPECT_TRUE(tree.search("abc"));
+    EXPECT_TRUE(tree.search("b"));
+    EXPECT_FALSE(tree.search("ab"));
+    EXPECT_FALSE(tree.search(""));
+    EXPECT_TRUE(tree.endsWith("bc"));
+    EXPECT_FALSE(tree.endsWith("b"));
+    EXPECT_TRUE(tree.endsWith("de"));
+    EXPECT_FALSE(tree.endsWith("abde"));
+    EXPECT_TRUE(tree.contains("bd"));
+    EXPECT_TRUE(tree.contains("y"));
+    EXPECT_FALSE(tree.contains("bx"));
+
+    // insertion discards the expanded nodes
+    EXPECT_TRUE(tree.insert("ab"));
+    EXPECT_EQ(tree.expandedNodeCount(), 0);
+    EXPECT_TRUE(tree.search("ab"));
+    EXPECT_TRUE(tree.endsWith("b"));
+
+    // a word inserted again doesn't become a proper suffix of itself
+    LazySuffixTree tree2 = {"ab", "ab"};
+
+    EXPECT_TRUE(tree2.search("ab"));
+    EXPECT_FALSE(tree2.endsWith("ab"));
+    EXPECT_TRUE(tree2.endsWith("b"));
+
+    tree2.clear();
+    EXPECT_TRUE(tree2.empty());
+    EXPECT_FALSE(tree2.contains("a"));
+}
+
+TEST(LazySuffixTree, Test_2)
+{
+    // only the branches of the queries are expanded
+    LazySuffixTree tree;
+
+    for (char c = 'a'; c <= 'z'; ++c)
+    {
+        tree.insert(std::string(1, c) + "xyz" + c);
+    }
+
+    EXPECT_TRUE(tree.search("qxyzq"));
+
+    auto expanded = tree.expandedNodeCount();
+
+    // root, its children, then "qxyzq" alone below "q"
+    EXPECT_LT(expanded, 40);
+    EXPECT_TRUE(tree.search("qxyzq"));
+    EXPECT_EQ(tree.expandedNodeCount(), expanded);
+}
+
+TEST(LazySuffixTree, Test_3)
+{
+    // same answers as CompressedSuffixTree
+    std::mt19937 gen(17);
+    std::uniform_int_distribution<int> letter('a', 'd');
+    std::uniform_int_distribution<size_t> length(1, 8);
+    std::vector<std::string> words;
+    CompressedSuffixTree<> reference;
+    LazySuffixTree tree;
+
+    for (size_t n = 0; n < 300; ++n)
+    {
+        std::string word(length(gen), ' ');
+
+        for (auto& c : word)
+        {
+            c = static_cast<char>(letter(gen));
+        }
+
+        if (n % 3 == 0)
+        {
+            reference.insert(word);
+            tree.insert(word);
+        }
+
+        words.push_back(word);
+    }
+
+    for (const auto& word : words)
+    {
+        for (size_t n = 0; n < word.size(); ++n)
+        {
+            for (size_t m = n + 1; m <= word.size(); ++m)
+            {
+                auto sv = std::string_view(word).substr(n, m - n);
+
+                ASSERT_EQ(tree.search(sv), reference.search(sv)) << sv;
+                ASSERT_EQ(tree.endsWith(sv), reference.endsWith(sv)) << sv;
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "CompressedSuffixTree.hpp"
+#include "LempelZiv.hpp"
+
+using namespace container;
+
+namespace
+{
+    std::vector<LzToken> factorize(std::string_view text)
+    {
+        std::vector<LzToken> res;
+
+        lz77(text, [&](const LzToken& token) { res.push_back(token); });
+
+        return res;
+    }
+
+    // longest previous factor at n, by brute force
+    size_t longestPreviousFactor(std::string_view text, size_t n)
+    {
+        size_t res = 0;
+
+        for (size_t source = 0; source < n; ++source)
+        {
+            size_t length = 0;
+
+            while (n + length < text.size() && text[source + length] == text[n + length])
+            {
+                ++length;
+            }
+
+            res = std::max(res, length);
+        }
+
+        return res;
+    }
+}
+
+TEST(LempelZiv, Test_1)
+{
+    EXPECT_TRUE(factorize("").empty());
+    EXPECT_EQ(factorize("a"), (std::vector<LzToken>{{0, 0, 'a'}}));
+
+    // the copy of the third token overlaps itself
+    EXPECT_EQ(factorize("abababab"),
+              (std::vector<LzToken>{{0, 0, 'a'}, {0, 0, 'b'}, {2, 5, 'b'}}));
+    EXPECT_EQ(factorize("abcabd"),
+              (std::vector<LzToken>{{0, 0, 'a'}, {0, 0, 'b'}, {0, 0, 'c'}, {3, 2, 'd'}}));
+
+    Lz77Decoder decoder;
+
+    lz77("abababab", decoder);
+    EXPECT_EQ(decoder.text(), "abababab");
+}
+
+TEST(LempelZiv, Test_2)
+{
+    // tokens are the longest previous factors, decoding gives the text back
+    std::mt19937 gen(29);
+    std::uniform_int_distribution<int> letter('a', 'c');
+
+    for (size_t length : {1, 2, 7, 50, 500})
+    {
+        std::string text(length, ' ');
+
+        for (auto& c : text)
+        {
+            c = static_cast<char>(letter(gen));
+        }
+
+        size_t n = 0;
+        Lz77Decoder decoder;
+
+        for (const auto& token : factorize(text))
+        {
+            auto expected = std::min(longestPreviousFactor(text, n), text.size() - n - 1);
+
+            ASSERT_EQ(token.length, expected) << text << " " << n;
+
+            if (token.length > 0)
+            {
+                ASSERT_LE(token.offset, n);
+                ASSERT_GT(token.offset, 0);
+            }
+
+            decoder(token);
+            n += token.length + 1;
+        }
+
+        EXPECT_EQ(n, text.size());
+        EXPECT_EQ(decoder.release(), text);
+    }
+}
+
+TEST(LempelZiv, Test_3)
+{
+    // relative Lempel-Ziv against the words of a tree
+    const CompressedSuffixTree tree = {"connection timeout", "error", "read"};
+    const RlzEncoder encoder(tree.begin(), tree.end());
+
+    EXPECT_EQ(encoder.reference(), "connection timeouterrorread");
+
+    for (std::string text : {"read error: connection timeout", "xyz", "", "timeout!"})
+    {
+        std::vector<LzToken> tokens;
+        RlzDecoder decoder(encoder.reference());
+
+        encoder.encode(text, [&](const LzToken& token)
+        {
+            tokens.push_back(token);
+            decoder(token);
+        });
+
+        EXPECT_EQ(decoder.text(), text);
+        EXPECT_LE(tokens.size(), text.size());
+    }
+
+    std::vector<LzToken> tokens;
+
+    encoder.encode("read error: connection timeout", [&](const LzToken& token)
+    {
+        tokens.push_back(token);
+    });
+
+    // "read" ' ', "error" ':', " " 'c', "onnection timeou" 't'
+    ASSERT_EQ(tokens.size(), 4);
+    EXPECT_EQ(tokens[0], (LzToken{23, 4, ' '}));
+    EXPECT_EQ(tokens[1], (LzToken{18, 5, ':'}));
+    EXPECT_EQ(tokens[2].length, 1);
+    EXPECT_EQ(tokens[2].literal, 'c');
+    EXPECT_EQ(tokens[3], (LzToken{1, 16, 't'}));
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "NumaReplicatedSuffixTree.hpp"
+
+using namespace container;
+
+TEST(NumaTopology, Test_1)
+{
+    EXPECT_EQ(NumaTopology::parseCpuList("0-3,8,10-11"),
+              (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+    EXPECT_TRUE(NumaTopology::parseCpuList("").empty());
+
+    auto root = std::filesystem::temp_directory_path()
+        / ("numa_topology_" + std::to_string(::getpid()));
+
+    std::filesystem::create_directories(root / "node1");
+    std::filesystem::create_directories(root / "node0");
+    std::filesystem::create_directories(root / "power");
+    std::ofstream(root / "node0" / "cpulist") << "0-1\n";
+    std::ofstream(root / "node1" / "cpulist") << "2-3\n";
+
+    auto topology = NumaTopology::detect(root);
+
+    std::filesystem::remove_all(root);
+
+    ASSERT_EQ(topology.nodeCount(), 2);
+    EXPECT_EQ(topology.cpus(1), (std::vector<int>{2, 3}));
+    EXPECT_EQ(topology.nodeOf(1), 0);
+    EXPECT_EQ(topology.nodeOf(3), 1);
+    EXPECT_EQ(topology.nodeOf(42), 0);
+
+    // no description means a single node
+    auto topology2 = NumaTopology::detect(root);
+
+    EXPECT_EQ(topology2.nodeCount(), 1);
+    EXPECT_EQ(topology2.currentNode(), 0);
+}
+
+TEST(NumaReplicatedSuffixTree, Test_1)
+{
+    const CompressedSuffixTree tree = {"abde", "abc", "b"};
+    const NumaReplicatedSuffixTree replicated{FrozenSuffixTree(tree)};
+
+    ASSERT_GE(replicated.replicaCount(), 1);
+    ASSERT_EQ(replicated.replicaCount(), replicated.topology().nodeCount());
+
+    for (size_t n = 0; n < replicated.replicaCount(); ++n)
+    {
+        EXPECT_EQ(replicated.replica(n).size(), tree.size());
+    }
+
+    EXPECT_TRUE(replicated.search("abc"));
+    EXPECT_FALSE(replicated.search("bc"));
+    EXPECT_TRUE(replicated.endsWith("de"));
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+
+#include <memory_resource>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "CompressedSuffixTree.hpp"
+#include "ParallelOperations.hpp"
+
+using namespace container;
+
+namespace
+{
+    std::vector<std::string> randomWords(size_t count, unsigned seed)
+    {
+        std::mt19937 gen(seed);
+        std::uniform_int_distribution<int> letter('a', 'h');
+        std::uniform_int_distribution<size_t> length(1, 12);
+        std::vector<std::string> words(count);
+
+        for (auto& word : words)
+        {
+            for (size_t n = length(gen); n > 0; --n)
+            {
+                word.push_back(static_cast<char>(letter(gen)));
+            }
+        }
+
+        return words;
+    }
+}
+
+TEST(ParallelOperations, Test_1)
+{
+    ThreadPool pool(4);
+    CompressedSuffixTree<> empty;
+
+    EXPECT_TRUE(parallelCopy(empty, pool).empty());
+    EXPECT_TRUE(parallelEqual(empty, CompressedSuffixTree<>{}, pool));
+
+    auto words = randomWords(2000, 1);
+    CompressedSuffixTree<> tree(words.cbegin(), words.cend());
+    auto copy = parallelCopy(tree, pool);
+
+    EXPECT_EQ(copy, tree);
+    EXPECT_TRUE(parallelEqual(copy, tree, pool));
+    EXPECT_EQ(copy.size(), tree.size());
+    EXPECT_EQ(copy.wordCount(), tree.wordCount());
+    EXPECT_EQ(copy.fingerprint(), tree.fingerprint());
+
+    for (const auto& word : words)
+    {
+        EXPECT_TRUE(copy.search(word));
+    }
+
+    // the copy doesn't share its nodes
+    EXPECT_TRUE(copy.erase(words[0]));
+    EXPECT_TRUE(tree.search(words[0]));
+    EXPECT_FALSE(parallelEqual(copy, tree, pool));
+    EXPECT_FALSE(parallelEqual(copy, empty, pool));
+
+    EXPECT_TRUE(copy.insert(words[0]));
+    EXPECT_TRUE(parallelEqual(copy, tree, pool));
+
+    CompressedSuffixTree<> other = {"abc"};
+
+    EXPECT_FALSE(parallelEqual(tree, other, pool));
+}
+
+TEST(ParallelOperations, Test_2)
+{
+    ThreadPool pool(4);
+    auto words = randomWords(1000, 2);
+
+    CompressedSuffixTree<std::allocator, int> tree;
+
+    for (size_t n = 0; n < words.size(); ++n)
+    {
+        tree.insert(words[n], static_cast<int>(n));
+    }
+
+    auto copy = parallelCopy(tree, pool);
+
+    EXPECT_TRUE(parallelEqual(copy, tree, pool));
+
+    // values are compared too
+    copy.find(words[0])->get() += 1;
+    EXPECT_FALSE(parallelEqual(copy, tree, pool));
+    EXPECT_FALSE(copy == tree);
+
+    auto generation = copy.generation();
+
+    parallelDestroy(copy, pool);
+    EXPECT_TRUE(copy.empty());
+    EXPECT_EQ(copy.size(), 0);
+    EXPECT_NE(copy.generation(), generation);
+
+    // a destroyed tree can be used again
+    EXPECT_TRUE(copy.insert("abc", 1));
+    EXPECT_TRUE(copy.endsWith("bc"));
+}
+
+TEST(ParallelOperations, Test_3)
+{
+    ThreadPool pool(2);
+    auto words = randomWords(1000, 3);
+
+    {
+        BackgroundReclaimer reclaimer;
+        CompressedSuffixTree<> tree(words.cbegin(), words.cend());
+
+        reclaimer.retire(std::move(tree));
+        EXPECT_TRUE(tree.empty());
+
+        reclaimer.drain();
+        EXPECT_EQ(reclaimer.pending(), 0);
+    }
+
+    {
+        BackgroundReclaimer reclaimer(&pool);
+        CompressedSuffixTree<> serving(words.cbegin(), words.cend());
+
+        for (unsigned n = 0; n < 5; ++n)
+        {
+            auto next = randomWords(500, 10 + n);
+            CompressedSuffixTree<> replacement(next.cbegin(), next.cend());
+
+            std::swap(serving, replacement);
+            reclaimer.retire(std::move(replacement));
+
+            EXPECT_TRUE(serving.search(next[0]));
+        }
+
+        // the destructor destroys the pending trees
+    }
+}
+
+TEST(ParallelOperations, Test_4)
+{
+    // an unsynchronized resource is only used by the calling thread
+    using Tree_t = CompressedSuffixTree<std::pmr::polymorphic_allocator>;
+
+    ThreadPool pool(4);
+    std::pmr::unsynchronized_pool_resource resource;
+    auto words = randomWords(1000, 4);
+    Tree_t tree{Tree_t::allocator_type(&resource)};
+
+    for (const auto& word : words)
+    {
+        tree.insert(word);
+    }
+
+    auto copy = parallelCopy(tree, pool);
+
+    // as the copy constructor, which doesn't propagate polymorphic allocators
+    EXPECT_EQ(copy.get_allocator().resource(), std::pmr::get_default_resource());
+    EXPECT_TRUE(parallelEqual(copy, tree, pool));
+
+    parallelDestroy(copy, pool);
+    EXPECT_TRUE(copy.empty());
+
+    BackgroundReclaimer reclaimer(&pool);
+
+    reclaimer.retire(std::move(tree));
+    EXPECT_TRUE(tree.empty());
+    EXPECT_EQ(reclaimer.pending(), 0);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
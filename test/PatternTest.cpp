@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <regex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "CompressedSuffixTree.hpp"
+
+using namespace container;
+
+using Strings = std::vector<std::string>;
+
+TEST(Pattern, Test_1)
+{
+    auto glob = Pattern::glob("err?r*timeout");
+
+    EXPECT_TRUE(glob.matches("error: read timeout"));
+    EXPECT_TRUE(glob.matches("errortimeout"));
+    EXPECT_FALSE(glob.matches("errtimeout"));
+    EXPECT_FALSE(glob.matches("error timeouts"));
+
+    auto glob2 = Pattern::glob("[a-c]x[!0-9]\\*");
+
+    EXPECT_TRUE(glob2.matches("bxy*"));
+    EXPECT_FALSE(glob2.matches("dxy*"));
+    EXPECT_FALSE(glob2.matches("bx1*"));
+    EXPECT_FALSE(glob2.matches("bxyz"));
+    EXPECT_TRUE(Pattern::glob("[]]").matches("]"));
+    EXPECT_TRUE(Pattern::glob("").matches(""));
+
+    auto regex = Pattern::regex("(ab|c)+d?[^x]*");
+
+    EXPECT_TRUE(regex.matches("abcab"));
+    EXPECT_TRUE(regex.matches("cdyy"));
+    EXPECT_FALSE(regex.matches("dyy"));
+    EXPECT_FALSE(regex.matches("abx"));
+    EXPECT_TRUE(Pattern::regex("a|").matches(""));
+    EXPECT_TRUE(Pattern::regex("(a*)*b").matches("aab"));
+    EXPECT_TRUE(Pattern::regex("a\\.b").matches("a.b"));
+    EXPECT_FALSE(Pattern::regex("a\\.b").matches("axb"));
+
+    for (const char* invalid : {"(a", "a)", "*a", "a|+", "[a", "[z-a]", "a\\"})
+    {
+        EXPECT_THROW(static_cast<void>(Pattern::regex(invalid)),
+                     std::invalid_argument) << invalid;
+    }
+
+    EXPECT_THROW(static_cast<void>(Pattern::glob("[ab")), std::invalid_argument);
+}
+
+TEST(Pattern, Test_2)
+{
+    const CompressedSuffixTree tree = {"error: timeout", "errxr timeout",
+                                       "warning: timeout", "error"};
+
+    EXPECT_EQ(tree.searchPattern(Pattern::glob("err?r*timeout")),
+              (Strings{"error: timeout", "errxr timeout"}));
+    EXPECT_EQ(tree.searchPattern(Pattern::glob("*")),
+              (Strings{"error", "error: timeout", "errxr timeout", "warning: timeout"}));
+    EXPECT_TRUE(tree.searchPattern(Pattern::glob("time*")).empty());
+    EXPECT_EQ(tree.substringsMatching(Pattern::glob("time*")),
+              (Strings{"time", "timeo", "timeou", "timeout"}));
+    EXPECT_EQ(tree.substringsMatching(Pattern::regex("r+")),
+              (Strings{"r", "rr"}));
+    EXPECT_TRUE(CompressedSuffixTree<>().searchPattern(Pattern::glob("*")).empty());
+
+    // only the subtrees the pattern can reach are visited
+    CompressedSuffixTree<std::allocator, void, instrumentation::Counting> tree2 =
+        {"abcdef", "bcdefg", "xyz", "xyy", "xzz"};
+
+    const auto& stats = tree2.instrumentation();
+
+    static_cast<void>(tree2.searchPattern(Pattern::glob("q*")));
+
+    // the first byte of each child of the root is rejected
+    auto totals = stats.totals(instrumentation::Operation::Pattern);
+
+    EXPECT_EQ(stats.count(instrumentation::Operation::Pattern), 1);
+    EXPECT_EQ(totals.labelBytesCompared, totals.nodesVisited);
+    EXPECT_LT(totals.nodesVisited, tree2.size() / 2);
+}
+
+TEST(Pattern, Test_3)
+{
+    // same results as std::regex on the words and their substrings
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<int> letter('a', 'c');
+    std::uniform_int_distribution<size_t> length(1, 6);
+    std::set<std::string> words;
+    std::set<std::string> substrings;
+    CompressedSuffixTree<> tree;
+
+    for (size_t n = 0; n < 100; ++n)
+    {
+        std::string word(length(gen), ' ');
+
+        for (auto& c : word)
+        {
+            c = static_cast<char>(letter(gen));
+        }
+
+        tree.insert(word);
+        words.insert(word);
+
+        for (size_t i = 0; i < word.size(); ++i)
+        {
+            for (size_t j = i + 1; j <= word.size(); ++j)
+            {
+                substrings.insert(word.substr(i, j - i));
+            }
+        }
+    }
+
+    for (const char* expression : {"a*", "(ab|c)+", "a.c?", "[^a]b*", "(a|b)*c(a|b)*",
+                                   "abc", "b?b?b?", ".*a.*"})
+    {
+        std::regex regex(expression);
+        Strings expectedWords;
+        Strings expectedSubstrings;
+
+        for (const auto& s : words)
+        {
+            if (std::regex_match(s, regex))
+            {
+                expectedWords.push_back(s);
+            }
+        }
+
+        for (const auto& s : substrings)
+        {
+            if (std::regex_match(s, regex))
+            {
+                expectedSubstrings.push_back(s);
+            }
+        }
+
+        auto pattern = Pattern::regex(expression);
+
+        EXPECT_EQ(tree.searchPattern(pattern), expectedWords) << expression;
+        EXPECT_EQ(tree.substringsMatching(pattern), expectedSubstrings) << expression;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
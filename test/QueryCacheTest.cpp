@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CompressedSuffixTree.hpp"
+#include "QueryCache.hpp"
+
+using namespace container;
+
+TEST(QueryCache, Test_1)
+{
+    CompressedSuffixTree<> tree = {"abde", "abc", "b"};
+    QueryCache cache(tree, 64, 4);
+
+    EXPECT_EQ(cache.capacity(), 64);
+
+    EXPECT_TRUE(cache.search("abc"));
+    EXPECT_EQ(cache.misses(), 1);
+    EXPECT_TRUE(cache.search("abc"));
+    EXPECT_EQ(cache.hits(), 1);
+    EXPECT_EQ(cache.misses(), 1);
+
+    // searches and suffixes are cached apart
+    EXPECT_FALSE(cache.search("de"));
+    EXPECT_TRUE(cache.endsWith("de"));
+    EXPECT_TRUE(cache.endsWith("de"));
+    EXPECT_EQ(cache.hits(), 2);
+    EXPECT_EQ(cache.misses(), 3);
+    EXPECT_EQ(cache.size(), 3);
+
+    // every modification of the tree makes the entries stale
+    auto generation = tree.generation();
+
+    EXPECT_TRUE(tree.insert("de"));
+    EXPECT_NE(tree.generation(), generation);
+    EXPECT_TRUE(cache.search("de"));
+    EXPECT_EQ(cache.misses(), 4);
+
+    generation = tree.generation();
+    EXPECT_FALSE(tree.erase("xyz"));
+    EXPECT_EQ(tree.generation(), generation);
+    EXPECT_TRUE(tree.erase("abc"));
+    EXPECT_FALSE(cache.search("abc"));
+    EXPECT_FALSE(cache.search("abc"));
+    EXPECT_EQ(cache.hits(), 3);
+
+    tree.clear();
+    EXPECT_FALSE(cache.endsWith("de"));
+    EXPECT_EQ(cache.misses(), 6);
+
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0);
+    EXPECT_EQ(cache.hits(), 0);
+    EXPECT_EQ(cache.misses(), 0);
+}
+
+TEST(QueryCache, Test_2)
+{
+    CompressedSuffixTree<> tree;
+    std::vector<std::string> words;
+
+    for (size_t n = 0; n < 100; ++n)
+    {
+        words.push_back("w" + std::to_string(n));
+        tree.insert(words.back());
+    }
+
+    QueryCache cache(tree, 16, 1);
+
+    for (const auto& word : words)
+    {
+        EXPECT_TRUE(cache.search(word));
+    }
+
+    // the capacity is never exceeded
+    EXPECT_EQ(cache.size(), 16);
+    EXPECT_EQ(cache.misses(), words.size());
+
+    // the referenced entries survive one turn of the clock
+    EXPECT_TRUE(cache.search("w99"));
+    EXPECT_EQ(cache.hits(), 1);
+    EXPECT_FALSE(cache.search("w100"));
+    EXPECT_TRUE(cache.search("w99"));
+    EXPECT_EQ(cache.hits(), 2);
+    EXPECT_EQ(cache.size(), 16);
+}
+
+TEST(QueryCache, Test_3)
+{
+    CompressedSuffixTree<> tree;
+
+    for (size_t n = 0; n < 1000; ++n)
+    {
+        tree.insert("word" + std::to_string(n));
+    }
+
+    QueryCache cache(tree, 256);
+    std::vector<std::thread> threads;
+    std::vector<size_t> errors(4);
+
+    for (size_t t = 0; t < errors.size(); ++t)
+    {
+        threads.emplace_back([&, t]()
+        {
+            for (size_t n = 0; n < 10000; ++n)
+            {
+                auto m = (n * 7 + t) % 2000;
+                auto word = "word" + std::to_string(m);
+
+                if (cache.search(word) != (m < 1000)
+                    || cache.endsWith(word.substr(1)) != (m < 1000))
+                {
+                    ++errors[t];
+                }
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (auto error : errors)
+    {
+        EXPECT_EQ(error, 0);
+    }
+
+    EXPECT_EQ(cache.hits() + cache.misses(), 2 * 10000 * errors.size());
+    EXPECT_LE(cache.size(), cache.capacity());
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "CompressedSuffixTree.hpp"
+
+using namespace container;
+
+TEST(QueryScheduler, Test_1)
+{
+    const CompressedSuffixTree<> empty;
+
+    EXPECT_FALSE(empty.co_search("a").get());
+    EXPECT_FALSE(empty.co_endsWith("a").get());
+
+    const CompressedSuffixTree tree = {"abde", "abc", "b", "xyz"};
+
+    EXPECT_TRUE(tree.co_search("abc").get());
+    EXPECT_TRUE(tree.co_search("b").get());
+    EXPECT_FALSE(tree.co_search("ab").get());
+    EXPECT_FALSE(tree.co_search("").get());
+    EXPECT_TRUE(tree.co_endsWith("bc").get());
+    EXPECT_FALSE(tree.co_endsWith("b").get());
+    EXPECT_TRUE(tree.co_endsWith("de").get());
+    EXPECT_FALSE(tree.co_endsWith("abde").get());
+
+    /* a lookup suspends for each node of its descent, for its label and
+       map, then for the first child entry when the query goes on : 3 times
+       for "ab", twice for "de" */
+    auto task = tree.co_search("abde");
+    size_t steps = 0;
+
+    while (!task.done())
+    {
+        task.resume();
+        ++steps;
+    }
+
+    EXPECT_TRUE(task.result());
+    EXPECT_EQ(steps, 6);
+
+    CompressedSuffixTree<std::allocator, void, instrumentation::None,
+                         normalization::AsciiCaseFold> tree2 = {"Hello"};
+
+    EXPECT_TRUE(tree2.co_search("HELLO").get());
+    EXPECT_TRUE(tree2.co_endsWith("LO").get());
+}
+
+TEST(QueryScheduler, Test_2)
+{
+    // interleaved lookups give the same answers as the synchronous ones
+    std::mt19937 gen(9);
+    std::uniform_int_distribution<int> letter('a', 'd');
+    std::uniform_int_distribution<size_t> length(1, 8);
+    std::vector<std::string> words;
+    CompressedSuffixTree<> tree;
+
+    for (size_t n = 0; n < 400; ++n)
+    {
+        std::string word(length(gen), ' ');
+
+        for (auto& c : word)
+        {
+            c = static_cast<char>(letter(gen));
+        }
+
+        if (n % 2 == 0)
+        {
+            tree.insert(word);
+        }
+
+        words.push_back(word);
+    }
+
+    for (size_t width : {1, 3, 16, 1000})
+    {
+        QueryScheduler scheduler(width);
+
+        auto found = scheduler.run(words.size(), [&](size_t n)
+        {
+            return tree.co_search(words[n]);
+        });
+        auto ending = scheduler.run(words.size(), [&](size_t n)
+        {
+            return tree.co_endsWith(words[n]);
+        });
+
+        ASSERT_EQ(found.size(), words.size());
+        ASSERT_EQ(ending.size(), words.size());
+
+        for (size_t n = 0; n < words.size(); ++n)
+        {
+            ASSERT_EQ(found[n], tree.search(words[n])) << words[n];
+            ASSERT_EQ(ending[n], tree.endsWith(words[n])) << words[n];
+        }
+    }
+
+    EXPECT_TRUE(QueryScheduler().run(0, [&](size_t n)
+    {
+        return tree.co_search(words[n]);
+    }).empty());
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
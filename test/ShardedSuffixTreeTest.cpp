@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "ShardedSuffixTree.hpp"
+
+using namespace container;
+
+TEST(ThreadPool, Test_1)
+{
+    ThreadPool pool(4);
+
+    ASSERT_EQ(pool.size(), 4);
+
+    auto future = pool.submit([] { return 42; });
+
+    EXPECT_EQ(future.get(), 42);
+
+    // tasks waiting for other tasks don't starve the pool
+    std::vector<std::future<size_t>> futures;
+
+    for (size_t n = 0; n < 16; ++n)
+    {
+        futures.push_back(pool.submit([&pool, n]
+        {
+            std::vector<std::future<size_t>> children;
+
+            for (size_t m = 0; m < 8; ++m)
+            {
+                children.push_back(pool.submit([n, m] { return n * m; }));
+            }
+
+            pool.wait(children);
+
+            return n;
+        }));
+    }
+
+    size_t sum = 0;
+
+    for (auto& f : futures)
+    {
+        sum += f.get();
+    }
+
+    EXPECT_EQ(sum, 120);
+}
+
+TEST(ShardedSuffixTree, Test_1)
+{
+    ThreadPool pool(4);
+    ShardedSuffixTree<> tree(8, pool);
+
+    ASSERT_EQ(tree.shardCount(), 8);
+    ASSERT_TRUE(tree.empty());
+
+    EXPECT_TRUE(tree.insert("abde"));
+    EXPECT_TRUE(tree.insert("abc"));
+    EXPECT_FALSE(tree.insert("abc"));
+    EXPECT_FALSE(tree.insert(""));
+
+    EXPECT_TRUE(tree.search("abde"));
+    EXPECT_FALSE(tree.search("ab"));
+    EXPECT_TRUE(tree.endsWith("bc"));
+    EXPECT_TRUE(tree.endsWith("de"));
+    EXPECT_FALSE(tree.endsWith("abc"));
+    ASSERT_EQ(tree.wordCount(), 2);
+
+    std::vector<std::string> words;
+
+    for (size_t n = 0; n < 500; ++n)
+    {
+        words.push_back("w" + std::to_string(n * 7919));
+    }
+
+    EXPECT_EQ(tree.insertBatch(words), 500);
+    EXPECT_EQ(tree.insertBatch(words), 0);
+    ASSERT_EQ(tree.wordCount(), 502);
+
+    CompressedSuffixTree reference(words.cbegin(), words.cend());
+
+    reference.insert("abde");
+    reference.insert("abc");
+
+    std::vector<std::string> queries = {"abc", "ab", "w0", "w7919", "w13", ""};
+    auto found = tree.searchBatch(queries);
+
+    ASSERT_EQ(found.size(), queries.size());
+
+    for (size_t n = 0; n < queries.size(); ++n)
+    {
+        EXPECT_EQ(found[n], reference.search(queries[n])) << queries[n];
+    }
+
+    std::vector<std::string> suffixes = {"919", "bc", "w0", "0", "7", "zz"};
+    auto ended = tree.endsWithBatch(suffixes);
+
+    ASSERT_EQ(ended.size(), suffixes.size());
+
+    for (size_t n = 0; n < suffixes.size(); ++n)
+    {
+        EXPECT_EQ(ended[n], reference.endsWith(suffixes[n])) << suffixes[n];
+        EXPECT_EQ(tree.endsWith(suffixes[n]), ended[n]);
+    }
+
+    EXPECT_TRUE(tree.erase("abc"));
+    EXPECT_FALSE(tree.search("abc"));
+    EXPECT_FALSE(tree.endsWith("bc"));
+
+    tree.clear();
+
+    ASSERT_TRUE(tree.empty());
+    ASSERT_EQ(tree.size(), 0);
+}
+
+TEST(ShardedSuffixTree, Test_2)
+{
+    // words are routed by their normalized form
+    using Tree_t = CompressedSuffixTree<std::allocator, void, instrumentation::None,
+                                        normalization::AsciiCaseFold>;
+
+    ThreadPool pool(2);
+    ShardedSuffixTree<Tree_t> tree(16, pool);
+
+    for (auto word : {"Foo", "Hello", "WORLD", "MiXeD"})
+    {
+        EXPECT_TRUE(tree.insert(word));
+    }
+
+    EXPECT_EQ(tree.shardOf("Foo"), tree.shardOf("foo"));
+    EXPECT_EQ(tree.shardOf("FOO"), tree.shardOf("foo"));
+    EXPECT_TRUE(tree.search("foo"));
+    EXPECT_TRUE(tree.search("HELLO"));
+    EXPECT_TRUE(tree.search("world"));
+    EXPECT_FALSE(tree.insert("FOO"));
+    EXPECT_FALSE(tree.insert("mixed"));
+    EXPECT_EQ(tree.wordCount(), 4);
+
+    const std::vector<std::string> words = {"fOO", "mixed", "hell", "World"};
+    const std::vector<bool> expected = {true, true, false, true};
+
+    EXPECT_EQ(tree.searchBatch(words), expected);
+
+    EXPECT_TRUE(tree.erase("hello"));
+    EXPECT_FALSE(tree.search("Hello"));
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
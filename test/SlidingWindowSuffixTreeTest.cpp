@@ -0,0 +1,208 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <algorithm>
+#include <random>
+#include <string>
+
+#include "SlidingWindowSuffixTree.hpp"
+
+using namespace container;
+
+TEST(SlidingWindowSuffixTree, Test_1)
+{
+    SlidingWindowSuffixTree tree(2);
+
+    ASSERT_TRUE(tree.empty());
+    ASSERT_TRUE(tree.insert(1, "abc"));
+    ASSERT_TRUE(tree.insert(2, "bcd"));
+    ASSERT_TRUE(tree.insert(3, "abc"));
+    ASSERT_TRUE(tree.insert(4, "xy"));
+    ASSERT_FALSE(tree.insert(3, "late"));
+    ASSERT_FALSE(tree.insert(5, ""));
+    ASSERT_EQ(tree.generationCount(), 2);
+
+    EXPECT_TRUE(tree.search("abc"));
+    EXPECT_TRUE(tree.endsWith("cd"));
+
+    // the first generation is released, "abc" lives in the second one
+    tree.expire(3);
+
+    EXPECT_EQ(tree.generationCount(), 1);
+    EXPECT_TRUE(tree.search("abc"));
+    EXPECT_FALSE(tree.search("bcd"));
+    EXPECT_FALSE(tree.endsWith("cd"));
+    EXPECT_TRUE(tree.endsWith("y"));
+    EXPECT_FALSE(tree.insert(2, "old"));
+
+    // only the expired part of the generation is erased
+    tree.expire(4);
+
+    EXPECT_EQ(tree.generationCount(), 1);
+    EXPECT_FALSE(tree.search("abc"));
+    EXPECT_FALSE(tree.endsWith("bc"));
+    EXPECT_TRUE(tree.search("xy"));
+
+    tree.expire(5);
+
+    EXPECT_TRUE(tree.empty());
+    EXPECT_EQ(tree.size(), 0);
+    EXPECT_EQ(tree.watermark(), 5);
+}
+
+TEST(SlidingWindowSuffixTree, Test_2)
+{
+    // same answers as a map of the last insertion of each word
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<int> letter('a', 'c');
+    std::uniform_int_distribution<size_t> length(1, 5);
+    SlidingWindowSuffixTree tree(16);
+    std::map<std::string, std::uint64_t> lastInsertions;
+    std::uint64_t watermark = 0;
+
+    for (std::uint64_t sequence = 0; sequence < 3000; ++sequence)
+    {
+        std::string word(length(gen), ' ');
+
+        for (auto& c : word)
+        {
+            c = static_cast<char>(letter(gen));
+        }
+
+        ASSERT_TRUE(tree.insert(sequence, word));
+        lastInsertions[word] = sequence;
+
+        if (sequence % 7 == 0 && sequence > 50)
+        {
+            watermark = std::max<std::uint64_t>(watermark, sequence - 50 + gen() % 10);
+            tree.expire(watermark);
+        }
+
+        if (sequence % 97 != 0)
+        {
+            continue;
+        }
+
+        for (const auto& [w, _] : lastInsertions)
+        {
+            bool alive = lastInsertions[w] >= watermark;
+            bool suffix = false;
+
+            for (const auto& [w2, last] : lastInsertions)
+            {
+                suffix = suffix
+                    || (last >= watermark && w2.size() > w.size()
+                        && w2.compare(w2.size() - w.size(), w.size(), w) == 0);
+            }
+
+            ASSERT_EQ(tree.search(w), alive) << w;
+            ASSERT_EQ(tree.endsWith(w), suffix) << w;
+        }
+    }
+
+    // expired generations don't accumulate
+    EXPECT_LE(tree.generationCount(), 60 / 16 + 2);
+}
+
+TEST(SlidingWindowSuffixTree, Test_3)
+{
+    // without expiry, old generations are merged instead of piling up
+    std::mt19937 gen(5);
+    std::uniform_int_distribution<int> letter('a', 'd');
+    std::uniform_int_distribution<size_t> length(1, 6);
+    SlidingWindowSuffixTree tree(8, 4);
+    std::map<std::string, std::uint64_t> lastInsertions;
+
+    for (std::uint64_t sequence = 0; sequence < 400; ++sequence)
+    {
+        std::string word(length(gen), ' ');
+
+        for (auto& c : word)
+        {
+            c = static_cast<char>(letter(gen));
+        }
+
+        ASSERT_TRUE(tree.insert(sequence, word));
+        lastInsertions[word] = sequence;
+        ASSERT_LE(tree.generationCount(), 4);
+    }
+
+    EXPECT_EQ(tree.generationCount(), 4);
+
+    // the merged generation still expires each word at its last insertion
+    for (std::uint64_t watermark = 0; watermark <= 400; watermark += 25)
+    {
+        tree.expire(watermark);
+
+        for (const auto& [w, last] : lastInsertions)
+        {
+            ASSERT_EQ(tree.search(w), last >= watermark) << w << " " << watermark;
+        }
+    }
+
+    EXPECT_TRUE(tree.empty());
+}
+
+TEST(SlidingWindowSuffixTree, Test_4)
+{
+    // a word inserted twice with the same id expires once
+    SlidingWindowSuffixTree tree(4, 2);
+
+    ASSERT_TRUE(tree.insert(5, "abc"));
+    ASSERT_TRUE(tree.insert(5, "abc"));
+    ASSERT_TRUE(tree.insert(6, "x"));
+
+    tree.expire(6);
+
+    EXPECT_FALSE(tree.search("abc"));
+    EXPECT_FALSE(tree.endsWith("bc"));
+    EXPECT_TRUE(tree.search("x"));
+
+    tree.expire(7);
+
+    EXPECT_TRUE(tree.empty());
+}
+
+TEST(SlidingWindowSuffixTree, Test_5)
+{
+    // merges spare the oldest generations, which are still released at once
+    SlidingWindowSuffixTree tree(8, 4);
+
+    for (std::uint64_t sequence = 0; sequence < 400; ++sequence)
+    {
+        ASSERT_TRUE(tree.insert(sequence, "w" + std::to_string(sequence)));
+    }
+
+    ASSERT_EQ(tree.generationCount(), 4);
+
+    auto size = tree.size();
+
+    tree.expire(8);
+
+    EXPECT_EQ(tree.generationCount(), 3);
+    EXPECT_LT(tree.size(), size);
+    EXPECT_FALSE(tree.search("w7"));
+    EXPECT_TRUE(tree.search("w8"));
+
+    // the next oldest generation gathers the insertions merged first
+    size_t count = tree.generationCount();
+    std::uint64_t watermark = 8;
+
+    while (tree.generationCount() == count)
+    {
+        tree.expire(++watermark);
+    }
+
+    EXPECT_EQ(tree.generationCount(), count - 1);
+    EXPECT_LT(watermark, 400);
+    EXPECT_FALSE(tree.search("w" + std::to_string(watermark - 1)));
+    EXPECT_TRUE(tree.search("w" + std::to_string(watermark)));
+    EXPECT_TRUE(tree.search("w399"));
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+#include <random>
+#include <stdexcept>
+
+#include "SmallSuffixTree.hpp"
+#include "CompressedSuffixTree.hpp"
+
+using namespace container;
+
+namespace
+{
+    constexpr SmallSuffixTree<8, 32> literalTree{"abde", "abc", "b", "cab"};
+
+    // built at compile time
+    static_assert(literalTree.wordCount() == 4);
+    static_assert(literalTree.search("abc"));
+    static_assert(!literalTree.search("ab"));
+    static_assert(literalTree.endsWith("ab"));
+    static_assert(literalTree.endsWith("de"));
+    static_assert(!literalTree.endsWith("abde"));
+
+    constexpr auto erasedTree = []
+    {
+        auto tree = literalTree;
+
+        tree.erase("abde");
+
+        return tree;
+    }();
+
+    static_assert(erasedTree == SmallSuffixTree<8, 32>{"abc", "b", "cab"});
+}
+
+TEST(SmallSuffixTree, Test_1)
+{
+    SmallSuffixTree<16, 64> tree;
+
+    ASSERT_TRUE(tree.empty());
+    ASSERT_TRUE(tree.insert("banana"));
+    ASSERT_FALSE(tree.insert("banana"));
+    ASSERT_FALSE(tree.insert(""));
+
+    ASSERT_TRUE(tree.search("banana"));
+    ASSERT_FALSE(tree.search("nana"));
+    ASSERT_TRUE(tree.endsWith("nana"));
+    ASSERT_TRUE(tree.endsWith("a"));
+    ASSERT_FALSE(tree.endsWith("nan"));
+
+    ASSERT_TRUE(tree.insert("nana"));
+    ASSERT_TRUE(tree.search("nana"));
+    ASSERT_TRUE(tree.endsWith("ana"));
+
+    ASSERT_TRUE(tree.erase("banana"));
+    ASSERT_FALSE(tree.erase("banana"));
+    ASSERT_FALSE(tree.search("banana"));
+    ASSERT_FALSE(tree.endsWith("anana"));
+    ASSERT_TRUE(tree.endsWith("ana"));
+    ASSERT_EQ(tree, (SmallSuffixTree<16, 64>{"nana"}));
+
+    tree.clear();
+
+    ASSERT_TRUE(tree.empty());
+    ASSERT_EQ(tree.size(), 0);
+    ASSERT_EQ(tree.wordCount(), 0);
+}
+
+TEST(SmallSuffixTree, Test_2)
+{
+    // the tree fails without being modified when full
+    SmallSuffixTree<4, 6> tree{"abc"};
+    auto copy = tree;
+
+    ASSERT_THROW(tree.insert("abcde"), std::length_error);
+    ASSERT_THROW(tree.insert("xyzt"), std::length_error);
+    ASSERT_EQ(tree, copy);
+    ASSERT_TRUE(tree.insert("bc"));
+    ASSERT_TRUE(tree.insert("d"));
+    ASSERT_EQ(tree.size(), tree.capacity() - 2);
+}
+
+TEST(SmallSuffixTree, Test_3)
+{
+    // same structure as the heap based tree
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> letter('a', 'c');
+    std::uniform_int_distribution<size_t> length(1, 8);
+    std::vector<std::string> words;
+    SmallSuffixTree<8, 512> tree;
+    CompressedSuffixTree<> reference;
+
+    for (size_t n = 0; n < 2000; ++n)
+    {
+        if (words.empty() || gen() % 3)
+        {
+            std::string word(length(gen), ' ');
+
+            for (auto& c : word)
+            {
+                c = static_cast<char>(letter(gen));
+            }
+
+            if (reference.size() + 2 * word.size() > tree.capacity())
+            {
+                continue;
+            }
+
+            ASSERT_EQ(tree.insert(word), reference.insert(word));
+            words.push_back(word);
+        }
+        else
+        {
+            const auto& word = words[gen() % words.size()];
+
+            ASSERT_EQ(tree.erase(word), reference.erase(word));
+        }
+
+        ASSERT_EQ(tree.size(), reference.size());
+        ASSERT_EQ(tree.wordCount(), reference.wordCount());
+    }
+
+    for (const auto& word : words)
+    {
+        for (size_t n = 0; n < word.size(); ++n)
+        {
+            ASSERT_EQ(tree.search(word.substr(n)), reference.search(word.substr(n)));
+            ASSERT_EQ(tree.endsWith(word.substr(n)),
+                      reference.endsWith(word.substr(n)));
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+
+#include "SuffixAutomaton.hpp"
+
+using namespace container;
+
+TEST(SuffixAutomaton, Test_1)
+{
+    const SuffixAutomaton empty;
+
+    EXPECT_EQ(empty.size(), 1);
+    EXPECT_TRUE(empty.contains(""));
+    EXPECT_FALSE(empty.contains("a"));
+
+    const SuffixAutomaton automaton("abcbc");
+
+    EXPECT_EQ(automaton.textLength(), 5);
+    EXPECT_TRUE(automaton.contains("bcb"));
+    EXPECT_TRUE(automaton.contains("abcbc"));
+    EXPECT_FALSE(automaton.contains("cc"));
+    EXPECT_FALSE(automaton.contains("abcbcb"));
+
+    // first occurrence of "bc" ends at 2
+    auto state = automaton.next(automaton.next(SuffixAutomaton::root, 'b'), 'c');
+
+    ASSERT_NE(state, SuffixAutomaton::npos);
+    EXPECT_EQ(automaton.firstEnd(state), 2);
+    EXPECT_EQ(automaton.next(state, 'a'), SuffixAutomaton::npos);
+}
+
+TEST(SuffixAutomaton, Test_2)
+{
+    // substrings of random texts, at most 2n - 1 states
+    std::mt19937 gen(23);
+    std::uniform_int_distribution<int> letter('a', 'c');
+
+    for (size_t length : {1, 2, 10, 100})
+    {
+        std::string text(length, ' ');
+
+        for (auto& c : text)
+        {
+            c = static_cast<char>(letter(gen));
+        }
+
+        const SuffixAutomaton automaton(text);
+
+        EXPECT_LE(automaton.size(), std::max<size_t>(2 * length - 1, 2));
+
+        for (size_t n = 0; n < 200; ++n)
+        {
+            std::string query(1 + n % 6, ' ');
+
+            for (auto& c : query)
+            {
+                c = static_cast<char>(letter(gen));
+            }
+
+            ASSERT_EQ(automaton.contains(query), text.find(query) != std::string::npos)
+                << text << " " << query;
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}